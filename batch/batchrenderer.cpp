@@ -0,0 +1,95 @@
+#include "batchrenderer.h"
+#include "image/displayformat.h"
+#include "image/imageloader.h"
+#include "image/windowlevel.h"
+#include "labelfile.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThreadPool>
+
+QImage renderLabels(const QImage &image, const QList<QSharedPointer<Label>> &labels) {
+    if (image.isNull()) {
+        return {};
+    }
+
+    QImage target;
+    if (isHighDepth(image.format())) {
+        const auto range = sampleRange(image);
+        target           = applyWindow(image, range.first, range.second);
+    } else {
+        target = toDisplayFormat(image);
+    }
+
+    QPainter painter(&target);
+
+    PaintInfo info;
+    info.painter    = &painter;
+    info.worldScale = 1.;
+    info.size       = target.size();
+    info.offset     = {0, 0};
+    for (const auto &label : labels) {
+        if (!label->category()->visible()) {
+            continue;
+        }
+        label->onPaint(info);
+    }
+
+    painter.end();
+    return target;
+}
+
+double BatchReport::imagesPerSecond() const {
+    return elapsedMs > 0 ? rendered * 1000. / double(elapsedMs) : 0.;
+}
+
+BatchReport renderBatch(const QList<BatchJob> &jobs, int threads,
+                        const std::function<void(int done, int total)> &progress) {
+    BatchReport   report;
+    QMutex        mutex;
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    if (threads > 0) {
+        pool.setMaxThreadCount(threads);
+    }
+
+    const auto total = static_cast<int>(jobs.size());
+    for (const auto &job : jobs) {
+        pool.start([ &, job ]() {
+            QString error;
+            auto    image = ImageLoader::decode(job.image, {}, {}, &error);
+
+            LabelFile file;
+            if (!image.isNull() && QFileInfo::exists(job.labels)) {
+                readLabelFile(job.labels, file, &error);
+            }
+
+            bool success = false;
+            if (!image.isNull() && error.isEmpty()) {
+                success = renderLabels(image, file.labels).save(job.output);
+                if (!success) {
+                    error = QString("%1: can not write").arg(job.output);
+                }
+            }
+
+            QMutexLocker locker(&mutex);
+            if (success) {
+                report.rendered++;
+            } else {
+                report.failed++;
+                report.errors.append(error.isEmpty() ? job.image : error);
+            }
+
+            if (progress) {
+                progress(report.rendered + report.failed, total);
+            }
+        });
+    }
+
+    pool.waitForDone();
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
@@ -0,0 +1,37 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include "label.h"
+
+#include <QImage>
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <functional>
+
+// labels of visible categories painted over the image at scale 1, the same paint code the
+// viewer uses. no widgets involved, it runs on any thread.
+QImage renderLabels(const QImage &image, const QList<QSharedPointer<Label>> &labels);
+
+struct BatchJob {
+    QString image;
+    QString labels; // label file, the image is rendered without labels if it does not exist
+    QString output;
+};
+
+struct BatchReport {
+    int         rendered  = 0;
+    int         failed    = 0;
+    qint64      elapsedMs = 0;
+    QStringList errors;
+
+    double imagesPerSecond() const;
+};
+
+// jobs rendered on `threads` workers, the ideal thread count for 0. `progress` is called
+// from the workers, one call at a time
+BatchReport renderBatch(const QList<BatchJob> &jobs, int threads = 0,
+                        const std::function<void(int done, int total)> &progress = {});
+
+#endif // BATCHRENDERER_H
@@ -50,6 +50,10 @@ void CircleEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF CircleEditor::boundingRect() const {
+    return {mCenter.x() - mRadius, mCenter.y() - mRadius, mRadius * 2, mRadius * 2};
+}
+
 bool CircleEditor::select(const QPointF &pos) {
 
     if (!isCreation()) {
@@ -135,6 +139,7 @@ QPointF CircleEditor::center() const {
 
 void CircleEditor::setCircle(const QPointF &center, double radius) {
     updateCircle(center, radius);
+    touch();
     if (radius > 0) {
         abortCreation();
     }
@@ -7,7 +7,8 @@ class CircleEditor : public LabelEditor {
 public:
     CircleEditor();
 
-    void onPaint(const PaintInfo &info) override;
+    void   onPaint(const PaintInfo &info) override;
+    QRectF boundingRect() const override;
 
     bool select(const QPointF &pos) override;
     void moving(const QPointF &curPos, const QPointF &lastPos) override;
@@ -15,7 +15,10 @@ void PolygonEditor::onPaint(const PaintInfo &info) {
     auto color = def->color();
     color.setAlpha(50);
     info.painter->setBrush(QBrush(color));
-    info.painter->drawPolygon(mPolygon);
+    // handles need the real vertices, only a resting editor is simplified
+    info.painter->drawPolygon(mSelected || mHighLighted || isCreation()
+                                  ? mPolygon
+                                  : mLod.polygon(mPolygon, info.worldScale));
 
     auto handleRadius = def->lineWidth() * 2. / info.worldScale;
 
@@ -37,28 +40,33 @@ void PolygonEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF PolygonEditor::boundingRect() const {
+    return mPolygon.boundingRect();
+}
+
 QStringList PolygonEditor::serialize() const {
     return {};
 }
 
-void PolygonEditor::deserialize(const QStringList &source) {
+bool PolygonEditor::deserialize(const QStringList &source) {
     Q_UNUSED(source)
+    return false;
 }
 
 bool PolygonEditor::select(const QPointF &pos) {
 
     if (!isCreation()) {
+        updateIndex();
+
         // press check
-        mPressed = mPolygon.containsPoint(pos, Qt::FillRule::WindingFill);
+        mPressed = mIndex.contains(mPolygon, pos);
 
         // press handle check
-        for (int i = 0; i < mPolygon.size(); i++) {
-            if (distance(mPolygon[ i ], pos) < mHandleDistance) {
-                mPressed        = true;
-                mHandleSelected = true;
-                mHandleIndex    = i;
-                break;
-            }
+        const int handle = mIndex.vertexAt(mPolygon, pos, mHandleDistance);
+        if (handle >= 0) {
+            mPressed        = true;
+            mHandleSelected = true;
+            mHandleIndex    = handle;
         }
 
         mSelected = mPressed;
@@ -75,6 +83,7 @@ bool PolygonEditor::select(const QPointF &pos) {
     } else {
         mPolygon.insert(mPolygon.size() - 1, pos);
     }
+    mIndexDirty = true;
 
     return true;
 }
@@ -86,27 +95,31 @@ void PolygonEditor::moving(const QPointF &curPos, const QPointF &lastPos) {
 
     if (isCreation()) {
         mPolygon[ mPolygon.size() - 1 ] = curPos;
+        mIndexDirty                     = true;
         return;
     }
 
+    // the index follows dragged vertices and translations in place
     if (mPressed) {
         if (!mHandleSelected) {
             auto delta = curPos - lastPos;
             mPolygon.translate(delta);
+            mIndex.translate(delta);
         } else {
+            const auto from          = mPolygon[ mHandleIndex ];
             mPolygon[ mHandleIndex ] = curPos;
+            mIndex.moveVertex(mPolygon, mHandleIndex, from);
         }
         return;
     }
 
-    mHighLighted       = mPolygon.containsPoint(curPos, Qt::FillRule::WindingFill);
-    mHandleHighLighted = false;
-    for (int i = 0; i < mPolygon.size(); i++) {
-        if (distance(mPolygon[ i ], curPos) < mHandleDistance) {
-            mHandleHighLighted = true;
-            mHandleIndex       = i;
-            break;
-        }
+    updateIndex();
+    mHighLighted = mIndex.contains(mPolygon, curPos);
+
+    const int handle   = mIndex.vertexAt(mPolygon, curPos, mHandleDistance);
+    mHandleHighLighted = handle >= 0;
+    if (mHandleHighLighted) {
+        mHandleIndex = handle;
     }
 
     if (mHandleHighLighted)
@@ -133,27 +146,17 @@ void PolygonEditor::modify(const QPointF &pos) {
 
         // remove handle
         mPolygon.removeAt(mHandleIndex);
+        mIndexDirty = true;
         return;
     }
 
-    for (int i = 0; i < mPolygon.size(); i++) {
-        // add handle
-        auto point0 = mPolygon[ i ];
-        auto point1 = mPolygon[ (i + 1) % mPolygon.size() ];
-
-        QLineF edge(point0, point1);
-        QLineF edge2(pos, pos + QPointF(mHandleDistance, 0));
-        edge2.setAngle(edge.angle() + 90);
-        edge2.setP1(edge2.p1() + edge2.p1() - edge2.p2());
-
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-        if (QLineF::BoundedIntersection == edge.intersects(edge2, nullptr)) {
-#else
-        if (QLineF::BoundedIntersection == edge.intersect(edge2, nullptr)) {
-#endif
-            mPolygon.insert(i + 1, pos);
-            break;
-        }
+    // add handle on the nearest edge
+    double     distance2 = 0.;
+    const auto edge      = nearestSegment(mPolygon.constData(), static_cast<int>(mPolygon.size()),
+                                          true, pos, &distance2);
+    if (edge >= 0 && distance2 < mHandleDistance * mHandleDistance) {
+        mPolygon.insert(edge + 1, pos);
+        mIndexDirty = true;
     }
 }
 
@@ -162,12 +165,22 @@ QPolygonF PolygonEditor::polygon() const {
 }
 
 void PolygonEditor::setPolygon(const QPolygonF &value) {
-    mPolygon = value;
+    mPolygon    = value;
+    mIndexDirty = true;
+    touch();
     if (!mPolygon.empty()) {
         abortCreation();
     }
 }
 
+void PolygonEditor::updateIndex() {
+    // vertex numbers shift on insertion and removal, the bins are built again
+    if (mIndexDirty) {
+        mIndex.build(mPolygon);
+        mIndexDirty = false;
+    }
+}
+
 QPen PolygonEditor::getOutlinePen(const PaintInfo &info) const {
     auto def = category();
     if (!def) {
@@ -2,6 +2,7 @@
 #define POLYGONEDITOR_H
 
 #include "labeleditor.h"
+#include "utils.h"
 #include <QPolygon>
 
 class PolygonEditor : public LabelEditor {
@@ -9,8 +10,9 @@ public:
     PolygonEditor();
 
     void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
     QStringList serialize() const override;
-    void        deserialize(const QStringList &source) override;
+    bool        deserialize(const QStringList &source) override;
 
     bool select(const QPointF &pos) override;
     void moving(const QPointF &curPos, const QPointF &lastPos) override;
@@ -23,7 +25,13 @@ public:
     QPen getOutlinePen(const PaintInfo &info) const;
 
 private:
-    QPolygonF mPolygon;
+    void updateIndex();
+
+private:
+    QPolygonF    mPolygon;
+    PolygonLod   mLod;
+    PolygonIndex mIndex;
+    bool         mIndexDirty = true;
 
     int          mHandleIndex        = 0;
     const double mHandleDistanceBase = 3.;
@@ -1,6 +1,8 @@
 #include "protractoreditor.h"
 #include "utils.h"
 
+#include <QFontMetricsF>
+
 ProtractorEditor::ProtractorEditor() = default;
 
 void ProtractorEditor::onPaint(const PaintInfo &info) {
@@ -29,7 +31,9 @@ void ProtractorEditor::onPaint(const PaintInfo &info) {
         textPen.setStyle(Qt::SolidLine);
         info.painter->setPen(textPen);
         info.painter->setFont(font);
-        info.painter->drawText(mPoints[ CENTER ], QString::number(angle, 'f', 3));
+        const auto text = QString::number(angle, 'f', 3);
+        info.painter->drawText(mPoints[ CENTER ], text);
+        mTextRect = QFontMetricsF(font).boundingRect(text);
 
         info.painter->setPen(pen);
 
@@ -76,7 +80,9 @@ void ProtractorEditor::onPaint(const PaintInfo &info) {
                 textPen.setStyle(Qt::SolidLine);
                 info.painter->setPen(textPen);
                 info.painter->setFont(font);
-                info.painter->drawText(mPoints[ CENTER ], QString::number(angle, 'f', 3));
+                const auto text = QString::number(angle, 'f', 3);
+                info.painter->drawText(mPoints[ CENTER ], text);
+                mTextRect = QFontMetricsF(font).boundingRect(text);
 
                 info.painter->setPen(pen);
                 break;
@@ -103,6 +109,15 @@ void ProtractorEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF ProtractorEditor::boundingRect() const {
+    QPolygonF points;
+    for (const auto &point : mPoints) {
+        points.append(point);
+    }
+
+    return points.boundingRect().united(mTextRect.translated(mPoints[ CENTER ]));
+}
+
 bool ProtractorEditor::select(const QPointF &pos) {
     if (!isCreation()) {
         mPressed = false;
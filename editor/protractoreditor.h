@@ -7,16 +7,18 @@ class ProtractorEditor : public LabelEditor {
 public:
     ProtractorEditor();
 
-    void onPaint(const PaintInfo &info) override;
-    bool select(const QPointF &pos) override;
-    void moving(const QPointF &curPos, const QPointF &lastPos) override;
-    void release() override;
+    void   onPaint(const PaintInfo &info) override;
+    QRectF boundingRect() const override;
+    bool   select(const QPointF &pos) override;
+    void   moving(const QPointF &curPos, const QPointF &lastPos) override;
+    void   release() override;
 
 private:
     QPen getOutlinePen(const PaintInfo &info) const;
 
 private:
     QPointF mPoints[ 3 ];
+    QRectF  mTextRect; // of the last paint, relative to the center
 
     enum Handle { CENTER, START, END, MAX_COUNT };
     Handle mHandle = CENTER;
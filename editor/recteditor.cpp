@@ -54,6 +54,10 @@ void RectEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RectEditor::boundingRect() const {
+    return mRect.normalized();
+}
+
 QRectF generateRect(const QPointF &a, const QPointF &b) {
     auto delta = a - b;
     auto left  = delta.x() > 0 ? b.x() : a.x();
@@ -158,6 +162,7 @@ QRectF RectEditor::rect() const {
 
 void RectEditor::setRect(const QRectF &value) {
     mRect = value;
+    touch();
     if (!mRect.isNull()) {
         abortCreation();
     }
@@ -14,15 +14,22 @@ void RegionEditor::onPaint(const PaintInfo &info) {
     if (mRenderedRegion.isNull()) {
         mRenderedRegion = QImage(info.size.toSize(), QImage::Format_ARGB32);
         mRenderedRegion.fill(Qt::transparent);
+        mMemory.setUsage(mRenderedRegion.sizeInBytes());
 
         mPainter.reset(new QPainter(&mRenderedRegion));
         mPainter->setPen(pen);
         mPainter->setCompositionMode(QPainter::CompositionMode_Source);
         mPainter->drawLines(mRegion);
+        if (!mRegion.isEmpty()) {
+            addPainted(QPolygonF(mRegion).boundingRect().adjusted(-1, -1, 1, 1));
+        }
     }
 
-    // region
-    info.painter->drawImage(info.offset, mRenderedRegion);
+    // region, only the painted part of it
+    if (!mPainted.isNull()) {
+        const auto part = mPainted.toAlignedRect();
+        info.painter->drawImage(QRectF(part).translated(info.offset), mRenderedRegion, part);
+    }
 
     if (isCreation()) {
         // indicator
@@ -46,6 +53,17 @@ void RegionEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RegionEditor::boundingRect() const {
+    // while drawing only the tool under the pointer and the last stroke to it change
+    if (isCreation()) {
+        const QRectF tool(mCenter.x() - mToolRadius, mCenter.y() - mToolRadius, mToolRadius * 2,
+                          mToolRadius * 2);
+        return mStroke.isNull() ? tool : tool.united(mStroke);
+    }
+
+    return mPainted;
+}
+
 bool RegionEditor::select(const QPointF &pos) {
     // press check
     auto pixel = pos.toPoint();
@@ -58,9 +76,10 @@ bool RegionEditor::select(const QPointF &pos) {
 
     mPressed = true;
     if (!isCreation()) {
-        auto color  = mRenderedRegion.pixelColor(pixel.x(), pixel.y());
-        auto alpha  = color.alpha();
-        mPressed    = alpha != 0;
+        // nothing was painted outside of the bounds, inside the alpha is read from the row
+        mPressed = mPainted.contains(pos) &&
+                   qAlpha(reinterpret_cast<const QRgb *>(
+                       mRenderedRegion.constScanLine(pixel.y()))[ pixel.x() ]) != 0;
         mInCreation = mPressed;
         return mPressed;
     }
@@ -77,12 +96,16 @@ bool RegionEditor::select(const QPointF &pos) {
     QRectF rect(mCenter.x() - mToolRadius, mCenter.y() - mToolRadius, mToolRadius * 2,
                 mToolRadius * 2);
     RECT == mToolShape ? mPainter->drawRect(rect) : mPainter->drawEllipse(rect);
+    if (PEN == mTool) {
+        addPainted(rect);
+    }
 
     return mPressed;
 }
 
 void RegionEditor::moving(const QPointF &curPos, const QPointF &lastPos) {
     mCenter = curPos;
+    mStroke = QRectF();
 
     if (!mPressed) {
         return;
@@ -96,6 +119,11 @@ void RegionEditor::moving(const QPointF &curPos, const QPointF &lastPos) {
 
     mPainter->setPen(pen);
     mPainter->drawLine(lastPos, curPos);
+    mStroke = QRectF(lastPos, curPos).normalized().adjusted(-mToolRadius, -mToolRadius,
+                                                            mToolRadius, mToolRadius);
+    if (PEN == mTool) {
+        addPainted(mStroke);
+    }
 }
 
 void RegionEditor::release() {
@@ -168,6 +196,8 @@ void RegionEditor::setReion(const QVector<QPointF> &value) {
     if (!mRenderedRegion.isNull()) {
         mRenderedRegion.fill(Qt::transparent);
     }
+    mPainted = QRectF();
+    touch();
 }
 
 RegionEditor::Tool RegionEditor::tool() const {
@@ -192,4 +222,10 @@ RegionEditor::Shape RegionEditor::toolShape() const {
 
 void RegionEditor::setToolShape(Shape shape) {
     mToolShape = shape;
+}
+
+void RegionEditor::addPainted(const QRectF &rect) {
+    // erasing keeps the bounds, they only have to hold every painted pixel
+    const auto bounds = mPainted.isNull() ? rect : mPainted.united(rect);
+    mPainted          = bounds.intersected(QRectF(mRenderedRegion.rect()));
 }
\ No newline at end of file
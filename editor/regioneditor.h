@@ -1,6 +1,7 @@
 #ifndef REGIONEDITOR_H
 #define REGIONEDITOR_H
 
+#include "image/memorybudget.h"
 #include "labeleditor.h"
 
 #include <QImage>
@@ -10,7 +11,8 @@ public:
     RegionEditor();
     ~RegionEditor() override;
 
-    void onPaint(const PaintInfo &info) override;
+    void   onPaint(const PaintInfo &info) override;
+    QRectF boundingRect() const override;
 
     bool select(const QPointF &pos) override;
     void moving(const QPointF &curPos, const QPointF &lastPos) override;
@@ -33,11 +35,17 @@ public:
     Shape toolShape() const;
     void  setToolShape(Shape shape);
 
+private:
+    void addPainted(const QRectF &rect);
+
 private:
     QVector<QPointF> mRegion;
 
     QImage                   mRenderedRegion;
+    QRectF                   mPainted; // bounds of the painted pixels, null if there are none
+    QRectF                   mStroke;  // swept by the last move while pressed, null otherwise
     QSharedPointer<QPainter> mPainter;
+    BudgetClient             mMemory{MemoryBudget::RegionMask};
 
     Tool    mTool       = PEN;
     Shape   mToolShape  = CIRCLE;
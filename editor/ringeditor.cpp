@@ -3,6 +3,8 @@
 
 #include <QPainterPath>
 
+#include <algorithm>
+
 RingEditor::RingEditor() = default;
 
 void RingEditor::onPaint(const PaintInfo &info) {
@@ -59,6 +61,11 @@ void RingEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RingEditor::boundingRect() const {
+    const auto radius = std::max(mInsideRadius, mOutsideRadius);
+    return {mCenter.x() - radius, mCenter.y() - radius, radius * 2, radius * 2};
+}
+
 bool RingEditor::select(const QPointF &pos) {
 
     if (!isCreation()) {
@@ -163,6 +170,7 @@ QPointF RingEditor::center() const {
 
 void RingEditor::setRing(const QPointF &center, double insideRadius, double outsideRadius) {
     updateRing(center, insideRadius, outsideRadius);
+    touch();
     if (insideRadius > 0 && outsideRadius > insideRadius) {
         abortCreation();
     }
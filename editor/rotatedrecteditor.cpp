@@ -56,6 +56,10 @@ void RotatedRectEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RotatedRectEditor::boundingRect() const {
+    return mRectPoints.boundingRect().united(mHandlePoints.boundingRect());
+}
+
 QRectF generateRect2(const QPointF &a, const QPointF &b) {
     auto delta = a - b;
     auto left  = delta.x() > 0 ? b.x() : a.x();
@@ -200,6 +204,7 @@ QRectF RotatedRectEditor::rect() const {
 
 void RotatedRectEditor::setRotatedRect(const QRectF &rect, double angle) {
     updateRotatedRect(rect, angle);
+    touch();
     if (!mRect.isNull()) {
         abortCreation();
     }
@@ -9,11 +9,12 @@ class RotatedRectEditor : public LabelEditor {
 public:
     RotatedRectEditor();
 
-    void onPaint(const PaintInfo &info) override;
-    bool select(const QPointF &pos) override;
-    void moving(const QPointF &curPos, const QPointF &lastPos) override;
-    void release() override;
-    void rotate(double angleDelta) override;
+    void   onPaint(const PaintInfo &info) override;
+    QRectF boundingRect() const override;
+    bool   select(const QPointF &pos) override;
+    void   moving(const QPointF &curPos, const QPointF &lastPos) override;
+    void   release() override;
+    void   rotate(double angleDelta) override;
 
     double angle() const;
     QRectF rect() const;
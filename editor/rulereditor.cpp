@@ -1,6 +1,8 @@
 #include "rulereditor.h"
 #include "utils.h"
 
+#include <QFontMetricsF>
+
 RulerEditor::RulerEditor() = default;
 
 void RulerEditor::onPaint(const PaintInfo &info) {
@@ -22,7 +24,9 @@ void RulerEditor::onPaint(const PaintInfo &info) {
     textPen.setStyle(Qt::SolidLine);
     info.painter->setPen(textPen);
     info.painter->setFont(font);
-    info.painter->drawText(line.center(), QString::number(line.length(), 'f', 3));
+    const auto text = QString::number(line.length(), 'f', 3);
+    info.painter->drawText(line.center(), text);
+    mTextRect = QFontMetricsF(font).boundingRect(text);
 
     info.painter->setPen(pen);
 
@@ -50,6 +54,11 @@ void RulerEditor::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RulerEditor::boundingRect() const {
+    const QLineF line(mStart, mEnd);
+    return QRectF(mStart, mEnd).normalized().united(mTextRect.translated(line.center()));
+}
+
 bool RulerEditor::select(const QPointF &pos) {
     QLineF line(mStart, mEnd);
 
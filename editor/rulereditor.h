@@ -7,10 +7,11 @@ class RulerEditor : public LabelEditor {
 public:
     RulerEditor();
 
-    void onPaint(const PaintInfo &info) override;
-    bool select(const QPointF &pos) override;
-    void moving(const QPointF &curPos, const QPointF &lastPos) override;
-    void release() override;
+    void   onPaint(const PaintInfo &info) override;
+    QRectF boundingRect() const override;
+    bool   select(const QPointF &pos) override;
+    void   moving(const QPointF &curPos, const QPointF &lastPos) override;
+    void   release() override;
 
 private:
     QPen getOutlinePen(const PaintInfo &info) const;
@@ -18,6 +19,7 @@ private:
 private:
     QPointF mStart;
     QPointF mEnd;
+    QRectF  mTextRect; // of the last paint, relative to the line center
 
     enum Handle { START, END };
     Handle mHandle = START;
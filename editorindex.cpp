@@ -0,0 +1,150 @@
+#include "editorindex.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+void EditorIndex::setCellSize(double size) {
+    if (size <= 0. || qFuzzyCompare(size, mCellSize)) {
+        return;
+    }
+
+    mCellSize = size;
+    mCells.clear();
+    mLarge.clear();
+    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+        bin(it.key(), *it);
+    }
+}
+
+void EditorIndex::insert(const Editor &editor) {
+    if (!editor || mEntries.contains(editor.data())) {
+        return;
+    }
+
+    Entry entry;
+    entry.editor = editor;
+    entry.order  = mOrder++;
+    bin(editor.data(), mEntries.insert(editor.data(), entry).value());
+}
+
+void EditorIndex::remove(const LabelEditor &editor) {
+    auto it = mEntries.find(&editor);
+    if (it == mEntries.end()) {
+        return;
+    }
+
+    unbin(&editor, *it);
+    mEntries.erase(it);
+}
+
+void EditorIndex::update(const Editor &editor) {
+    auto it = mEntries.find(editor.data());
+    if (it == mEntries.end()) {
+        return;
+    }
+
+    const auto box = editor->boundingRect();
+    if (box == it->box && !box.isNull()) {
+        return;
+    }
+
+    unbin(editor.data(), *it);
+    bin(editor.data(), *it);
+}
+
+void EditorIndex::clear() {
+    mEntries.clear();
+    mCells.clear();
+    mLarge.clear();
+}
+
+QVector<EditorIndex::Editor> EditorIndex::query(std::initializer_list<QPointF> points,
+                                                double radius) const {
+    // candidates of the cells around each point, then the exact box test
+    QSet<const LabelEditor *> found;
+    for (const auto &pos : points) {
+        auto       candidates = mLarge;
+        const auto cells =
+            cellsOf(QRectF(pos.x() - radius, pos.y() - radius, radius * 2., radius * 2.));
+        for (int row = cells.top(); row <= cells.bottom(); row++) {
+            for (int column = cells.left(); column <= cells.right(); column++) {
+                candidates += mCells.value(key(column, row));
+            }
+        }
+
+        for (const auto *editor : candidates) {
+            const auto &box = mEntries.constFind(editor)->box;
+            if (box.isNull() || box.adjusted(-radius, -radius, radius, radius).contains(pos)) {
+                found.insert(editor);
+            }
+        }
+    }
+
+    QVector<const Entry *> entries;
+    entries.reserve(found.size());
+    for (const auto *editor : found) {
+        entries.append(&*mEntries.constFind(editor));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry *a, const Entry *b) { return a->order > b->order; });
+
+    QVector<Editor> editors;
+    editors.reserve(entries.size());
+    for (const auto *entry : entries) {
+        editors.append(entry->editor);
+    }
+    return editors;
+}
+
+quint64 EditorIndex::key(int column, int row) {
+    return (quint64(quint32(column)) << 32) | quint32(row);
+}
+
+QRect EditorIndex::cellsOf(const QRectF &box) const {
+    const auto left   = static_cast<int>(std::floor(box.left() / mCellSize));
+    const auto top    = static_cast<int>(std::floor(box.top() / mCellSize));
+    const auto right  = static_cast<int>(std::floor(box.right() / mCellSize));
+    const auto bottom = static_cast<int>(std::floor(box.bottom() / mCellSize));
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+void EditorIndex::bin(const LabelEditor *editor, Entry &entry) {
+    entry.box   = entry.editor->boundingRect();
+    entry.cells = QRect();
+
+    const auto cells = entry.box.isNull() ? QRect() : cellsOf(entry.box);
+    if (cells.isEmpty() || qint64(cells.width()) * cells.height() > mMaxCells) {
+        mLarge.append(editor);
+        return;
+    }
+
+    entry.cells = cells;
+    for (int row = cells.top(); row <= cells.bottom(); row++) {
+        for (int column = cells.left(); column <= cells.right(); column++) {
+            mCells[ key(column, row) ].append(editor);
+        }
+    }
+}
+
+void EditorIndex::unbin(const LabelEditor *editor, const Entry &entry) {
+    if (entry.cells.isEmpty()) {
+        mLarge.removeOne(editor);
+        return;
+    }
+
+    for (int row = entry.cells.top(); row <= entry.cells.bottom(); row++) {
+        for (int column = entry.cells.left(); column <= entry.cells.right(); column++) {
+            auto it = mCells.find(key(column, row));
+            if (it == mCells.end()) {
+                continue;
+            }
+
+            it->removeOne(editor);
+            if (it->isEmpty()) {
+                mCells.erase(it);
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef EDITORINDEX_H
+#define EDITORINDEX_H
+
+#include "labeleditor.h"
+
+#include <QHash>
+#include <QRectF>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <initializer_list>
+
+// editors binned by bounding box on a hashed uniform grid in image coordinates, the mouse only
+// tests the editors near it instead of all of them. boxes are cached, an editor that moved or
+// rotated has to be updated.
+class EditorIndex {
+public:
+    using Editor = QSharedPointer<LabelEditor>;
+
+    // image pixels per cell, editors are binned again
+    void setCellSize(double size);
+
+    void insert(const Editor &editor);
+    void remove(const LabelEditor &editor);
+    void update(const Editor &editor);
+    void clear();
+
+    // editors whose box padded by `radius` holds one of `points`, the last inserted first
+    QVector<Editor> query(std::initializer_list<QPointF> points, double radius) const;
+
+private:
+    struct Entry {
+        Editor  editor;
+        QRectF  box;
+        QRect   cells; // empty if the editor is in mLarge
+        quint64 order = 0;
+    };
+
+    static quint64 key(int column, int row);
+
+    QRect cellsOf(const QRectF &box) const;
+    void  bin(const LabelEditor *editor, Entry &entry);
+    void  unbin(const LabelEditor *editor, const Entry &entry);
+
+private:
+    QHash<const LabelEditor *, Entry>            mEntries;
+    QHash<quint64, QVector<const LabelEditor *>> mCells;
+    QVector<const LabelEditor *>                 mLarge; // no box or too many cells, always tested
+    double                                       mCellSize = 64.;
+    quint64                                      mOrder    = 0;
+
+    const int mMaxCells = 64; // per editor
+};
+
+#endif // EDITORINDEX_H
@@ -0,0 +1,28 @@
+#include "glcanvas.h"
+
+#include <QOpenGLContext>
+#include <QPainter>
+
+#include <utility>
+
+GLCanvas::GLCanvas(Paint paint, QWidget *parent)
+    : QOpenGLWidget(parent)
+    , mPaint(std::move(paint)) {
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+bool GLCanvas::isSupported() {
+    QOpenGLContext context;
+    if (!context.create()) {
+        return false;
+    }
+
+    // the paint engine needs shaders
+    return context.isOpenGLES() || context.format().majorVersion() >= 2;
+}
+
+void GLCanvas::paintGL() {
+    QPainter painter(this);
+    mPaint(painter);
+}
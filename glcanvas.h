@@ -0,0 +1,29 @@
+#ifndef GLCANVAS_H
+#define GLCANVAS_H
+
+#include <QOpenGLWidget>
+
+#include <functional>
+
+// OpenGL surface over an ImageViewer. mouse and key events pass through to the viewer, painting
+// goes through the viewer's paint code on the OpenGL paint engine: images are uploaded once as
+// textures and reused while they do not change, panning and zooming only change the matrix.
+// works on software rasterizers like Mesa llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+class GLCanvas : public QOpenGLWidget {
+    Q_OBJECT
+public:
+    using Paint = std::function<void(QPainter &painter)>;
+
+    explicit GLCanvas(Paint paint, QWidget *parent = nullptr);
+
+    // an OpenGL 2 or ES 2 context can be made, false without any driver
+    static bool isSupported();
+
+protected:
+    void paintGL() override;
+
+private:
+    Paint mPaint;
+};
+
+#endif // GLCANVAS_H
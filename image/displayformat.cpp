@@ -0,0 +1,81 @@
+#include "displayformat.h"
+
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int bandHeight = 256;
+} // namespace
+
+QImage::Format displayFormat(const QImage &image) {
+    if (isDisplayFormat(image.format())) {
+        return image.format();
+    }
+
+    return image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+}
+
+bool isDisplayFormat(QImage::Format format) {
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+void toDisplayFormat(const QImage &src, const QRect &srcRect, QImage &dst, const QPoint &dstPos) {
+    const auto rect = srcRect.intersected(src.rect());
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    // a copy of the part keeps the color table and handles formats below a byte per pixel
+    const auto converted = src.copy(rect).convertToFormat(dst.format());
+    const auto bytes     = static_cast<size_t>(rect.width()) * 4;
+    for (int y = 0; y < rect.height(); y++) {
+        std::memcpy(dst.scanLine(dstPos.y() + y) + static_cast<size_t>(dstPos.x()) * 4,
+                    converted.constScanLine(y), bytes);
+    }
+}
+
+QImage toDisplayFormat(const QImage &image) {
+    const auto format = displayFormat(image);
+    if (image.isNull() || image.format() == format) {
+        return image;
+    }
+
+    if (image.height() <= bandHeight) {
+        return image.convertToFormat(format);
+    }
+
+    QImage dst(image.size(), format);
+    if (dst.isNull()) {
+        return {};
+    }
+    dst.setDotsPerMeterX(image.dotsPerMeterX());
+    dst.setDotsPerMeterY(image.dotsPerMeterY());
+
+    QVector<int> bands;
+    for (int y = 0; y < image.height(); y += bandHeight) {
+        bands.append(y);
+    }
+
+    // each band is a view on the source rows, converted and copied into its own rows of dst
+    auto      *bits   = dst.bits();
+    const auto stride = static_cast<size_t>(dst.bytesPerLine());
+    const auto target = dst.format();
+    QtConcurrent::blockingMap(bands, [ &image, bits, stride, target ](int top) {
+        const int height = std::min(bandHeight, image.height() - top);
+        QImage    band(image.constScanLine(top), image.width(), height,
+                       static_cast<int>(image.bytesPerLine()), image.format());
+        band.setColorTable(image.colorTable());
+
+        const auto converted = band.convertToFormat(target);
+        const auto bytes     = static_cast<size_t>(image.width()) * 4;
+        for (int y = 0; y < height; y++) {
+            std::memcpy(bits + static_cast<size_t>(top + y) * stride, converted.constScanLine(y),
+                        bytes);
+        }
+    });
+
+    return dst;
+}
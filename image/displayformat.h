@@ -0,0 +1,16 @@
+#ifndef DISPLAYFORMAT_H
+#define DISPLAYFORMAT_H
+
+#include <QImage>
+
+// formats the raster paint engine draws without converting: RGB32 for opaque images,
+// premultiplied ARGB32 otherwise
+QImage::Format displayFormat(const QImage &image);
+bool           isDisplayFormat(QImage::Format format);
+
+// image converted to its display format, large images are converted in parallel row bands
+QImage toDisplayFormat(const QImage &image);
+// `srcRect` of the image converted into `dst`, which is in the display format of `src`
+void toDisplayFormat(const QImage &src, const QRect &srcRect, QImage &dst, const QPoint &dstPos);
+
+#endif // DISPLAYFORMAT_H
@@ -0,0 +1,40 @@
+#include "framequeue.h"
+
+#include <utility>
+
+bool FrameQueue::push(QImage frame) {
+    QMutexLocker locker(&mMutex);
+    mStats.received++;
+    if (!mPending.isNull()) {
+        mStats.dropped++;
+    }
+
+    mPending = std::move(frame);
+
+    const bool wake = !mScheduled;
+    mScheduled      = true;
+    return wake;
+}
+
+QImage FrameQueue::take() {
+    QMutexLocker locker(&mMutex);
+    mScheduled = false;
+    if (mPending.isNull()) {
+        return {};
+    }
+
+    mStats.presented++;
+    return std::exchange(mPending, QImage());
+}
+
+FrameQueue::Stats FrameQueue::stats() const {
+    QMutexLocker locker(&mMutex);
+    return mStats;
+}
+
+void FrameQueue::reset() {
+    QMutexLocker locker(&mMutex);
+    mPending   = QImage();
+    mScheduled = false;
+    mStats     = {};
+}
@@ -0,0 +1,32 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <QImage>
+#include <QMutex>
+
+// newest frame mailbox between a producer and painting. together with the producer's buffer
+// and the painted frame it makes a triple buffer, frames replaced before a paint are dropped.
+class FrameQueue {
+public:
+    struct Stats {
+        quint64 received  = 0;
+        quint64 presented = 0;
+        quint64 dropped   = 0;
+    };
+
+    // any thread. true if the consumer has to be woken up, false while a wake up is pending
+    bool push(QImage frame);
+    // newest frame since the previous take, null if there is none
+    QImage take();
+
+    Stats stats() const;
+    void  reset();
+
+private:
+    mutable QMutex mMutex;
+    QImage         mPending;
+    bool           mScheduled = false;
+    Stats          mStats;
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,183 @@
+#include "imageloader.h"
+#include "rawformat.h"
+
+#include <QFile>
+#include <QImageReader>
+
+#include <algorithm>
+
+namespace {
+// file that reports read progress and fails reads once canceled, which aborts the decoder
+class ProgressFile : public QFile {
+public:
+    ProgressFile(const QString &name, const std::function<bool()> &isCanceled,
+                 const std::function<void(int)> &progress)
+        : QFile(name)
+        , mIsCanceled(isCanceled)
+        , mProgress(progress) {}
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        if (mIsCanceled && mIsCanceled()) {
+            return -1;
+        }
+
+        auto count = QFile::readData(data, maxSize);
+        if (mProgress && count > 0 && size() > 0) {
+            auto percent = static_cast<int>((pos() + count) * 100 / size());
+            if (percent != mPercent) {
+                mPercent = percent;
+                mProgress(std::min(percent, 100));
+            }
+        }
+
+        return count;
+    }
+
+private:
+    const std::function<bool()> &mIsCanceled;
+    const std::function<void(int)> &mProgress;
+
+    int mPercent = -1;
+};
+} // namespace
+
+class ImageDecoder : public QObject {
+    Q_OBJECT
+public:
+    explicit ImageDecoder(const std::atomic<quint64> *latest)
+        : mLatest(latest) {}
+
+    void decode(quint64 request, const QString &filepath) {
+        const std::function<bool()> isCanceled = [ this, request ]() {
+            return mLatest->load() != request;
+        };
+        if (isCanceled()) {
+            return;
+        }
+
+        QString error;
+        auto    image = ImageLoader::decode(
+            filepath, isCanceled, [ this, request ](int percent) { emit progress(request, percent); },
+            &error);
+        if (isCanceled()) {
+            return;
+        }
+
+        emit decoded(request, image, error);
+    }
+
+signals:
+    void progress(quint64 request, int percent);
+    void decoded(quint64 request, const QImage &image, const QString &error);
+
+private:
+    const std::atomic<quint64> *mLatest;
+};
+
+ImageLoader::ImageLoader(QObject *parent)
+    : QObject(parent)
+    , mDecoder(new ImageDecoder(&mLatest)) {
+    mDecoder->moveToThread(&mThread);
+    connect(&mThread, &QThread::finished, mDecoder, &QObject::deleteLater);
+    connect(mDecoder, &ImageDecoder::progress, this, &ImageLoader::onProgress);
+    connect(mDecoder, &ImageDecoder::decoded, this, &ImageLoader::onDecoded);
+
+    mThread.setObjectName("ImageLoader");
+    mThread.start();
+}
+
+ImageLoader::~ImageLoader() {
+    mLatest = 0;
+    mThread.quit();
+    mThread.wait();
+}
+
+bool ImageLoader::isLoading() const {
+    return mLoading;
+}
+
+QString ImageLoader::filepath() const {
+    return mFilepath;
+}
+
+QImage ImageLoader::decode(const QString &filepath, const std::function<bool()> &isCanceled,
+                           const std::function<void(int)> &progress, QString *error) {
+    // uncompressed frames are mapped, pages are read when pixels are touched
+    auto mapped = mapRawImage(filepath);
+    if (!mapped.isNull()) {
+        if (progress) {
+            progress(100);
+        }
+        return mapped;
+    }
+
+    ProgressFile file(filepath, isCanceled, progress);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return {};
+    }
+
+    QImageReader reader(&file);
+    auto         image = reader.read();
+    if (image.isNull() && error) {
+        *error = reader.errorString();
+    }
+
+    return image;
+}
+
+void ImageLoader::load(const QString &filepath) {
+    if (mLoading) {
+        emit canceled(mFilepath);
+    }
+
+    mRequest  = mLatest + 1;
+    mLatest   = mRequest;
+    mFilepath = filepath;
+    mLoading  = true;
+    emit started(filepath);
+
+    auto *decoder = mDecoder;
+    auto  request = mRequest;
+    QMetaObject::invokeMethod(
+        mDecoder, [ decoder, request, filepath ]() { decoder->decode(request, filepath); },
+        Qt::QueuedConnection);
+}
+
+void ImageLoader::cancel() {
+    if (!mLoading) {
+        return;
+    }
+
+    // no request matches the next id, the decoder aborts at its next read
+    mLatest  = mRequest + 1;
+    mLoading = false;
+    emit canceled(mFilepath);
+}
+
+void ImageLoader::onProgress(quint64 request, int percent) {
+    if (request != mRequest || !mLoading) {
+        return;
+    }
+
+    emit progress(percent);
+}
+
+void ImageLoader::onDecoded(quint64 request, const QImage &image, const QString &error) {
+    if (request != mRequest || !mLoading) {
+        return;
+    }
+
+    mLoading = false;
+    if (image.isNull()) {
+        emit failed(mFilepath, error);
+        return;
+    }
+
+    emit loaded(image, mFilepath);
+}
+
+#include "imageloader.moc"
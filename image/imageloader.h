@@ -0,0 +1,52 @@
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include <QImage>
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+#include <functional>
+
+class ImageDecoder;
+
+// decodes image files on a worker thread, a newer load supersedes the pending one
+class ImageLoader : public QObject {
+    Q_OBJECT
+public:
+    explicit ImageLoader(QObject *parent = nullptr);
+    ~ImageLoader() override;
+
+    bool    isLoading() const;
+    QString filepath() const;
+
+    // decode on the calling thread, `isCanceled` is polled while the file is read
+    static QImage decode(const QString &filepath, const std::function<bool()> &isCanceled = {},
+                         const std::function<void(int)> &progress = {}, QString *error = nullptr);
+
+public slots:
+    void load(const QString &filepath);
+    void cancel();
+
+signals:
+    void started(const QString &filepath);
+    void progress(int percent);
+    void loaded(const QImage &image, const QString &filepath);
+    void failed(const QString &filepath, const QString &error);
+    void canceled(const QString &filepath);
+
+private:
+    void onProgress(quint64 request, int percent);
+    void onDecoded(quint64 request, const QImage &image, const QString &error);
+
+private:
+    QThread       mThread;
+    ImageDecoder *mDecoder = nullptr;
+
+    std::atomic<quint64> mLatest{0}; // read by the decoder to drop superseded requests
+    quint64              mRequest = 0;
+    QString              mFilepath;
+    bool                 mLoading = false;
+};
+
+#endif // IMAGELOADER_H
@@ -0,0 +1,195 @@
+#include "imageprefetcher.h"
+#include "imageloader.h"
+#include "rawformat.h"
+
+#include <QCollator>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+qint64 estimatedBytes(const QString &filepath) {
+    auto layout = readRawLayout(filepath);
+    auto size   = layout.isValid() ? layout.size : QImageReader(filepath).size();
+    return qint64(size.width()) * size.height() * 4;
+}
+} // namespace
+
+ImagePrefetcher::ImagePrefetcher(QObject *parent)
+    : QObject(parent)
+    , mState(new State)
+    , mMemory(MemoryBudget::Prefetch, 0, [ this ](qint64 bytes) { trim(bytes); }) {
+    mCache.setMaxCost(512 * 1024);
+    mPool.setMaxThreadCount(2);
+}
+
+ImagePrefetcher::~ImagePrefetcher() {
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->wanted.clear();
+    }
+
+    // running decodes post to this object and abort once nothing is wanted
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+void ImagePrefetcher::setCurrentFile(const QString &filepath) {
+    const QFileInfo info(filepath);
+    if (info.absolutePath() != mFolder || !mFiles.contains(info.absoluteFilePath())) {
+        scanFolder(filepath);
+    }
+
+    mIndex = static_cast<int>(mFiles.indexOf(info.absoluteFilePath()));
+    prefetch();
+}
+
+QString ImagePrefetcher::currentFile() const {
+    return mFiles.value(mIndex);
+}
+
+QStringList ImagePrefetcher::files() const {
+    return mFiles;
+}
+
+QString ImagePrefetcher::neighbour(int delta) const {
+    if (mIndex < 0) {
+        return {};
+    }
+
+    return mFiles.value(mIndex + delta);
+}
+
+QImage ImagePrefetcher::cachedImage(const QString &filepath) {
+    auto *image = mCache.object(QFileInfo(filepath).absoluteFilePath());
+    return image ? *image : QImage();
+}
+
+bool ImagePrefetcher::isPending(const QString &filepath) const {
+    return mPending.contains(QFileInfo(filepath).absoluteFilePath());
+}
+
+void ImagePrefetcher::setRange(int count) {
+    mRange = std::max(0, count);
+    prefetch();
+}
+
+int ImagePrefetcher::range() const {
+    return mRange;
+}
+
+void ImagePrefetcher::setMaxCost(int kilobytes) {
+    mCache.setMaxCost(kilobytes);
+    updateUsage();
+}
+
+int ImagePrefetcher::maxCost() const {
+    return mCache.maxCost();
+}
+
+void ImagePrefetcher::scanFolder(const QString &filepath) {
+    const QFileInfo info(filepath);
+    mFolder = info.absolutePath();
+
+    QStringList filters;
+    for (const auto &format : QImageReader::supportedImageFormats()) {
+        filters.append("*." + QString::fromLatin1(format));
+    }
+    filters << "*.npy"
+            << "*.raw"
+            << "*.bin";
+
+    QDir dir(mFolder);
+    auto names = dir.entryList(filters, QDir::Files | QDir::Readable);
+
+    // frame2 before frame10
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    std::sort(names.begin(), names.end(), collator);
+
+    mFiles.clear();
+    for (const auto &name : names) {
+        mFiles.append(dir.absoluteFilePath(name));
+    }
+
+    if (!mFiles.contains(info.absoluteFilePath())) {
+        mFiles.append(info.absoluteFilePath());
+    }
+}
+
+void ImagePrefetcher::prefetch() {
+    // nearest neighbours first, alternating directions. the current file is left to the viewer,
+    // which reports progress and can cancel, unless it was already decoding here as a neighbour
+    QStringList order;
+    if (mIndex >= 0) {
+        for (int i = 1; i <= mRange; i++) {
+            for (auto index : {mIndex + i, mIndex - i}) {
+                if (index >= 0 && index < mFiles.size()) {
+                    order.append(mFiles[ index ]);
+                }
+            }
+        }
+    }
+
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->wanted = QSet<QString>(order.begin(), order.end());
+        if (mIndex >= 0 && mPending.contains(mFiles[ mIndex ])) {
+            mState->wanted.insert(mFiles[ mIndex ]);
+        }
+    }
+
+    auto state  = mState;
+    auto budget = qint64(mCache.maxCost()) * 1024;
+    for (const auto &filepath : order) {
+        if (mCache.contains(filepath) || mPending.contains(filepath)) {
+            continue;
+        }
+
+        mPending.insert(filepath);
+        mPool.start([ this, state, filepath, budget ]() {
+            // huge images would evict everything else, they are left to the viewer
+            const auto isCanceled = [ state, filepath ]() {
+                QMutexLocker locker(&state->mutex);
+                return !state->wanted.contains(filepath);
+            };
+
+            QImage image;
+            if (!isCanceled() && estimatedBytes(filepath) <= budget / 2) {
+                image = ImageLoader::decode(filepath, isCanceled);
+            }
+
+            QMetaObject::invokeMethod(
+                this, [ this, filepath, image ]() { onDecoded(filepath, image); },
+                Qt::QueuedConnection);
+        });
+    }
+}
+
+void ImagePrefetcher::onDecoded(const QString &filepath, const QImage &image) {
+    mPending.remove(filepath);
+    if (!image.isNull()) {
+        const auto cost = static_cast<int>(std::max<qint64>(1, image.sizeInBytes() / 1024));
+        mCache.insert(filepath, new QImage(image), cost);
+        updateUsage();
+    }
+
+    emit prefetched(filepath, !image.isNull());
+}
+
+void ImagePrefetcher::trim(qint64 bytes) {
+    // shrinking the limit drops the least recently used images first
+    const int kilobytes = static_cast<int>(std::min<qint64>(bytes / 1024 + 1, INT_MAX));
+    const int maxCost   = mCache.maxCost();
+    mCache.setMaxCost(mCache.totalCost() - std::min(kilobytes, mCache.totalCost()));
+    mCache.setMaxCost(maxCost);
+    updateUsage();
+}
+
+void ImagePrefetcher::updateUsage() {
+    mMemory.setUsage(qint64(mCache.totalCost()) * 1024);
+}
@@ -0,0 +1,64 @@
+#ifndef IMAGEPREFETCHER_H
+#define IMAGEPREFETCHER_H
+
+#include "memorybudget.h"
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+// folder of the current file, the neighbours in both directions are decoded ahead of time
+// into a memory bounded cache
+class ImagePrefetcher : public QObject {
+    Q_OBJECT
+public:
+    explicit ImagePrefetcher(QObject *parent = nullptr);
+    ~ImagePrefetcher() override;
+
+    void        setCurrentFile(const QString &filepath);
+    QString     currentFile() const;
+    QStringList files() const;
+    // file `delta` steps away from the current one, empty at the ends of the folder
+    QString neighbour(int delta) const;
+
+    QImage cachedImage(const QString &filepath);
+    bool   isPending(const QString &filepath) const;
+
+    void setRange(int count);
+    int  range() const;
+    void setMaxCost(int kilobytes);
+    int  maxCost() const;
+
+signals:
+    void prefetched(const QString &filepath, bool success);
+
+private:
+    void scanFolder(const QString &filepath);
+    void prefetch();
+    void onDecoded(const QString &filepath, const QImage &image);
+    void trim(qint64 bytes);
+    void updateUsage();
+
+private:
+    struct State {
+        QMutex        mutex;
+        QSet<QString> wanted;
+    };
+
+    QStringList mFiles;
+    QString     mFolder;
+    int         mIndex = -1;
+    int         mRange = 2;
+
+    QSharedPointer<State>   mState;
+    QSet<QString>           mPending;
+    QCache<QString, QImage> mCache;
+    QThreadPool             mPool;
+    BudgetClient            mMemory;
+};
+
+#endif // IMAGEPREFETCHER_H
@@ -0,0 +1,156 @@
+#include "imagepyramid.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+ImagePyramid::ImagePyramid(QObject *parent)
+    : QObject(parent)
+    , mMemory(MemoryBudget::Pyramid, 2, [ this ](qint64) { clear(); }) {
+    connect(&mWatcher, &QFutureWatcher<void>::finished, this, [ this ]() {
+        mMemory.setUsage(mState ? mState->bytes.load() : 0);
+        emit levelsReady();
+    });
+}
+
+ImagePyramid::~ImagePyramid() {
+    // worker owns the state too, it stops at the next level
+    cancel();
+}
+
+void ImagePyramid::build(const QImage &image, const Converter &convert) {
+    cancel();
+
+    mState.reset(new State);
+    mState->levels.append(image);
+    mMemory.setUsage(0);
+
+    if (image.isNull() || std::max(image.width(), image.height()) < mMinLevelSize * 2) {
+        return;
+    }
+
+    auto       state   = mState;
+    const auto minSize = mMinLevelSize;
+    mWatcher.setFuture(QtConcurrent::run([ state, image, convert, minSize ]() {
+        auto current = downsample(image, convert);
+        while (!state->canceled && !current.isNull()) {
+            {
+                QMutexLocker locker(&state->mutex);
+                state->levels.append(current);
+            }
+            state->bytes += current.sizeInBytes();
+
+            if (std::max(current.width(), current.height()) <= minSize) {
+                break;
+            }
+            current = downsample(current);
+        }
+    }));
+}
+
+void ImagePyramid::cancel() {
+    if (mState) {
+        mState->canceled = true;
+    }
+}
+
+void ImagePyramid::clear() {
+    cancel();
+    mState.reset();
+    mMemory.setUsage(0);
+}
+
+int ImagePyramid::levelCount() const {
+    if (!mState) {
+        return 0;
+    }
+
+    QMutexLocker locker(&mState->mutex);
+    return mState->levels.size();
+}
+
+QImage ImagePyramid::level(int index) const {
+    if (!mState) {
+        return {};
+    }
+
+    QMutexLocker locker(&mState->mutex);
+    return mState->levels.value(index);
+}
+
+QImage ImagePyramid::levelForScale(double scale) const {
+    if (!mState) {
+        return {};
+    }
+
+    QMutexLocker locker(&mState->mutex);
+    if (mState->levels.isEmpty()) {
+        return {};
+    }
+
+    const auto &levels    = mState->levels;
+    const auto  baseWidth = double(levels.first().width());
+    for (auto i = levels.size() - 1; i > 0; i--) {
+        if (levels[ i ].width() / baseWidth >= scale) {
+            return levels[ i ];
+        }
+    }
+
+    return levels.first();
+}
+
+QImage ImagePyramid::downsample(const QImage &src, const Converter &convert) {
+    QImage dst((src.width() + 1) / 2, (src.height() + 1) / 2, QImage::Format_ARGB32_Premultiplied);
+    if (dst.isNull()) {
+        return {};
+    }
+
+    // RGB32 is opaque premultiplied ARGB32
+    if ((src.format() == QImage::Format_ARGB32_Premultiplied ||
+         src.format() == QImage::Format_RGB32) &&
+        !convert) {
+        boxFilter(src, dst, 0);
+        return dst;
+    }
+
+    // other formats are converted in bands, never as a whole
+    for (int y = 0; y < src.height(); y += mBandHeight) {
+        auto band = src.copy(0, y, src.width(), std::min(mBandHeight, src.height() - y));
+        if (convert) {
+            band = convert(band);
+        }
+        band = band.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        boxFilter(band, dst, y / 2);
+    }
+
+    return dst;
+}
+
+void ImagePyramid::boxFilter(const QImage &src, QImage &dst, int dstTop) {
+    // src must be premultiplied, channels can be averaged independently
+    const int lastColumn = src.width() - 1;
+    const int lastRow    = src.height() - 1;
+    for (int y = 0; y * 2 <= lastRow; y++) {
+        const auto *row0 = reinterpret_cast<const quint32 *>(src.constScanLine(y * 2));
+        const auto *row1 =
+            reinterpret_cast<const quint32 *>(src.constScanLine(std::min(y * 2 + 1, lastRow)));
+        auto *out = reinterpret_cast<quint32 *>(dst.scanLine(dstTop + y));
+
+        for (int x = 0; x < dst.width(); x++) {
+            const int  x0 = x * 2;
+            const int  x1 = std::min(x0 + 1, lastColumn);
+            const auto a  = row0[ x0 ];
+            const auto b  = row0[ x1 ];
+            const auto c  = row1[ x0 ];
+            const auto d  = row1[ x1 ];
+
+            // two channels per 32bit word, four 8bit values fit in a 16bit lane
+            const quint32 rb = (a & 0x00ff00ff) + (b & 0x00ff00ff) + (c & 0x00ff00ff) +
+                               (d & 0x00ff00ff) + 0x00020002;
+            const quint32 ag = ((a >> 8) & 0x00ff00ff) + ((b >> 8) & 0x00ff00ff) +
+                               ((c >> 8) & 0x00ff00ff) + ((d >> 8) & 0x00ff00ff) + 0x00020002;
+
+            out[ x ] = ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+        }
+    }
+}
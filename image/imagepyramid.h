@@ -0,0 +1,62 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include "memorybudget.h"
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+// mip levels of an image, each level is the previous one box filtered by 2x2.
+// level 0 is the source image, the other levels are built in background.
+class ImagePyramid : public QObject {
+    Q_OBJECT
+public:
+    explicit ImagePyramid(QObject *parent = nullptr);
+    ~ImagePyramid() override;
+
+    using Converter = std::function<QImage(const QImage &)>;
+
+    // `convert` maps rows of the source to displayable pixels, e.g. a window of 16bit data
+    void build(const QImage &image, const Converter &convert = {});
+    void cancel();
+    // no levels at all, level 0 included
+    void clear();
+
+    int    levelCount() const;
+    QImage level(int index) const;
+    // coarsest level that still has at least `scale` pixels per source pixel
+    QImage levelForScale(double scale) const;
+
+    static QImage downsample(const QImage &src, const Converter &convert = {});
+
+signals:
+    void levelsReady();
+
+private:
+    static void boxFilter(const QImage &src, QImage &dst, int dstTop);
+
+private:
+    static constexpr int mBandHeight = 64; // even, rows converted at a time
+
+    struct State {
+        QMutex              mutex;
+        QVector<QImage>     levels;
+        std::atomic<bool>   canceled{false};
+        std::atomic<qint64> bytes{0}; // levels other than the source
+    };
+
+    QSharedPointer<State> mState;
+    QFutureWatcher<void>  mWatcher;
+    BudgetClient          mMemory;
+
+    const int mMinLevelSize = 128;
+};
+
+#endif // IMAGEPYRAMID_H
@@ -0,0 +1,153 @@
+#include "memorybudget.h"
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include <algorithm>
+
+MemoryBudget::MemoryBudget(QObject *parent)
+    : QObject(parent) {
+    bool       ok       = false;
+    const auto megabyte = qEnvironmentVariableIntValue("VIEWER_MEMORY_BUDGET_MB", &ok);
+    mLimit              = qint64(ok && megabyte > 0 ? megabyte : 4096) * 1024 * 1024;
+}
+
+MemoryBudget *MemoryBudget::instance() {
+    // evictions run on the gui thread, whichever thread asks first
+    static auto *budget = []() {
+        auto *object = new MemoryBudget;
+        if (auto *app = QCoreApplication::instance()) {
+            object->moveToThread(app->thread());
+        }
+        return object;
+    }();
+
+    return budget;
+}
+
+void MemoryBudget::setLimit(qint64 bytes) {
+    {
+        QMutexLocker locker(&mMutex);
+        mLimit = bytes;
+    }
+
+    requestEnforce();
+}
+
+qint64 MemoryBudget::limit() const {
+    QMutexLocker locker(&mMutex);
+    return mLimit;
+}
+
+qint64 MemoryBudget::used() const {
+    QMutexLocker locker(&mMutex);
+    return mUsed;
+}
+
+qint64 MemoryBudget::used(Consumer consumer) const {
+    QMutexLocker locker(&mMutex);
+    qint64       bytes = 0;
+    for (const auto &client : mClients) {
+        if (client.consumer == consumer) {
+            bytes += client.bytes;
+        }
+    }
+
+    return bytes;
+}
+
+int MemoryBudget::addClient(Consumer consumer, int priority, const Evict &evict) {
+    QMutexLocker locker(&mMutex);
+    const int    id = mNextId++;
+    mClients.insert(id, {consumer, priority, evict, 0});
+    return id;
+}
+
+void MemoryBudget::removeClient(int id) {
+    {
+        QMutexLocker locker(&mMutex);
+        mUsed -= mClients.value(id).bytes;
+        mClients.remove(id);
+    }
+
+    emit usageChanged();
+}
+
+void MemoryBudget::setUsage(int id, qint64 bytes) {
+    {
+        QMutexLocker locker(&mMutex);
+        auto         client = mClients.find(id);
+        if (client != mClients.end()) {
+            mUsed += bytes - client->bytes;
+            client->bytes = bytes;
+        }
+    }
+
+    requestEnforce();
+    emit usageChanged();
+}
+
+void MemoryBudget::requestEnforce() {
+    {
+        QMutexLocker locker(&mMutex);
+        if (mUsed <= mLimit || mEnforcing) {
+            return;
+        }
+        mEnforcing = true;
+    }
+
+    // never evict from inside the caller, it may hold its own locks
+    QMetaObject::invokeMethod(this, &MemoryBudget::enforce, Qt::QueuedConnection);
+}
+
+void MemoryBudget::enforce() {
+    QVector<int> order;
+    {
+        QMutexLocker locker(&mMutex);
+        for (auto it = mClients.cbegin(); it != mClients.cend(); ++it) {
+            if (it->evict && it->bytes > 0) {
+                order.append(it.key());
+            }
+        }
+
+        std::sort(order.begin(), order.end(), [ this ](int a, int b) {
+            return mClients[ a ].priority < mClients[ b ].priority;
+        });
+    }
+
+    for (auto id : order) {
+        Evict  evict;
+        qint64 excess = 0;
+        {
+            QMutexLocker locker(&mMutex);
+            excess = mUsed - mLimit;
+            if (excess <= 0 || !mClients.contains(id)) {
+                continue;
+            }
+            evict = mClients[ id ].evict;
+        }
+
+        evict(excess);
+    }
+
+    QMutexLocker locker(&mMutex);
+    mEnforcing = false;
+}
+
+BudgetClient::BudgetClient(MemoryBudget::Consumer consumer, int priority,
+                           const MemoryBudget::Evict &evict)
+    : mId(MemoryBudget::instance()->addClient(consumer, priority, evict)) {}
+
+BudgetClient::~BudgetClient() {
+    MemoryBudget::instance()->removeClient(mId);
+}
+
+void BudgetClient::setUsage(qint64 bytes) {
+    if (mBytes.exchange(bytes) != bytes) {
+        MemoryBudget::instance()->setUsage(mId, bytes);
+    }
+}
+
+qint64 BudgetClient::usage() const {
+    return mBytes;
+}
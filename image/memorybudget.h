@@ -0,0 +1,77 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+#include <atomic>
+#include <functional>
+
+// process wide accounting of large buffers. consumers report what they hold, when the total
+// goes over the limit evictable consumers are asked to release memory, lowest priority first.
+// the limit comes from VIEWER_MEMORY_BUDGET_MB, 4GB otherwise.
+class MemoryBudget : public QObject {
+    Q_OBJECT
+public:
+    enum Consumer { DecodedImage, DisplayCache, Pyramid, Tiles, Prefetch, RegionMask, LabelLayers };
+    Q_ENUM(Consumer)
+
+    // reclaim about `bytes`, called on the gui thread. the client reports its new usage
+    using Evict = std::function<void(qint64 bytes)>;
+
+    static MemoryBudget *instance();
+
+    void   setLimit(qint64 bytes);
+    qint64 limit() const;
+    qint64 used() const;
+    qint64 used(Consumer consumer) const;
+
+    // thread safe
+    int  addClient(Consumer consumer, int priority = 0, const Evict &evict = {});
+    void removeClient(int id);
+    void setUsage(int id, qint64 bytes);
+
+signals:
+    void usageChanged();
+
+private:
+    explicit MemoryBudget(QObject *parent = nullptr);
+    void requestEnforce();
+    void enforce();
+
+private:
+    struct Client {
+        Consumer consumer = DecodedImage;
+        int      priority = 0;
+        Evict    evict;
+        qint64   bytes = 0;
+    };
+
+    mutable QMutex     mMutex;
+    QHash<int, Client> mClients;
+    int                mNextId    = 1;
+    qint64             mUsed      = 0;
+    qint64             mLimit     = 0;
+    bool               mEnforcing = false; // queued or running
+};
+
+// registration of one consumer, usage is removed from the budget with it
+class BudgetClient {
+public:
+    explicit BudgetClient(MemoryBudget::Consumer consumer, int priority = 0,
+                          const MemoryBudget::Evict &evict = {});
+    ~BudgetClient();
+
+    BudgetClient(const BudgetClient &)            = delete;
+    BudgetClient &operator=(const BudgetClient &) = delete;
+
+    void   setUsage(qint64 bytes);
+    qint64 usage() const;
+
+private:
+    int                 mId;
+    std::atomic<qint64> mBytes{0};
+};
+
+#endif // MEMORYBUDGET_H
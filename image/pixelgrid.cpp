@@ -0,0 +1,195 @@
+#include "pixelgrid.h"
+
+#include <QFontMetrics>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const QString glyphs = QStringLiteral("0123456789.-+e");
+
+QString formatValue(double value) {
+    if (value == std::floor(value) && std::abs(value) < 1e6) {
+        return QString::number(static_cast<qint64>(value));
+    }
+    return QString::number(value, 'g', 4);
+}
+} // namespace
+
+void PixelGrid::paint(QPainter *painter, const QImage &pixels, const QRect &source,
+                      const ValueReader &values) {
+    const auto transform = painter->worldTransform();
+    const auto target =
+        transform.mapRect(QRectF(source)).toAlignedRect().intersected(painter->viewport());
+    if (target.isEmpty()) {
+        return;
+    }
+
+    magnify(pixels, target, painter->viewport().size(), transform);
+
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->drawImage(target.topLeft(), mBlocks, QRect(QPoint(0, 0), target.size()));
+    paintGrid(painter, source, target, transform);
+    if (values && transform.m11() >= mValueScale) {
+        paintValues(painter, pixels, source, target, transform, values);
+    }
+    painter->restore();
+}
+
+void PixelGrid::magnify(const QImage &pixels, const QRect &target, const QSize &viewport,
+                        const QTransform &transform) {
+    // the target shrinks at the image edges, only its top left part of the buffer is used. the
+    // buffer is only allocated again when the viewport grows
+    if (mBlocks.width() < target.width() || mBlocks.height() < target.height() ||
+        mBlocks.format() != pixels.format()) {
+        const auto size = mBlocks.format() == pixels.format()
+                              ? viewport.expandedTo(mBlocks.size())
+                              : viewport;
+        mBlocks         = QImage(size.expandedTo(target.size()), pixels.format());
+    }
+
+    // nearest source pixel of each screen pixel center
+    const auto nearest = [](int screen, double scale, double offset, int last) {
+        const auto pos = static_cast<int>(std::floor((screen + 0.5 - offset) / scale));
+        return std::clamp(pos, 0, last);
+    };
+
+    mColumns.resize(target.width());
+    for (int x = 0; x < target.width(); x++) {
+        mColumns[ x ] =
+            nearest(target.left() + x, transform.m11(), transform.dx(), pixels.width() - 1);
+    }
+
+    const auto rowBytes = static_cast<size_t>(target.width()) * sizeof(quint32);
+    int        lastRow  = -1;
+    for (int y = 0; y < target.height(); y++) {
+        const int row =
+            nearest(target.top() + y, transform.m22(), transform.dy(), pixels.height() - 1);
+        auto *out = reinterpret_cast<quint32 *>(mBlocks.scanLine(y));
+
+        // rows of the same source row are copies
+        if (row == lastRow) {
+            std::memcpy(out, mBlocks.constScanLine(y - 1), rowBytes);
+            continue;
+        }
+        lastRow = row;
+
+        // columns are sorted, each run of one source pixel is a fill
+        const auto *in = reinterpret_cast<const quint32 *>(pixels.constScanLine(row));
+        for (int x = 0; x < target.width();) {
+            int end = x + 1;
+            while (end < target.width() && mColumns[ end ] == mColumns[ x ]) {
+                end++;
+            }
+            std::fill(out + x, out + end, in[ mColumns[ x ] ]);
+            x = end;
+        }
+    }
+}
+
+void PixelGrid::paintGrid(QPainter *painter, const QRect &source, const QRect &target,
+                          const QTransform &transform) {
+    // one batch of lines on the pixel borders
+    mLines.clear();
+    for (int x = source.left(); x <= source.right() + 1; x++) {
+        const auto screen = static_cast<int>(std::lround(x * transform.m11() + transform.dx()));
+        if (screen >= target.left() && screen <= target.right()) {
+            mLines.append(QLine(screen, target.top(), screen, target.bottom()));
+        }
+    }
+    for (int y = source.top(); y <= source.bottom() + 1; y++) {
+        const auto screen = static_cast<int>(std::lround(y * transform.m22() + transform.dy()));
+        if (screen >= target.top() && screen <= target.bottom()) {
+            mLines.append(QLine(target.left(), screen, target.right(), screen));
+        }
+    }
+
+    painter->setPen(QPen(QColor(128, 128, 128, 120), 0));
+    painter->drawLines(mLines);
+}
+
+void PixelGrid::paintValues(QPainter *painter, const QImage &pixels, const QRect &source,
+                            const QRect &target, const QTransform &transform,
+                            const ValueReader &values) {
+    if (mAtlas.isNull()) {
+        buildAtlas();
+    }
+
+    const double cellWidth  = transform.m11();
+    const double cellHeight = transform.m22();
+
+    mFragments.clear();
+    for (int y = source.top(); y <= source.bottom(); y++) {
+        for (int x = source.left(); x <= source.right(); x++) {
+            const QRectF cell(x * cellWidth + transform.dx(), y * cellHeight + transform.dy(),
+                              cellWidth, cellHeight);
+            if (!cell.intersects(target) || !pixels.valid(x, y)) {
+                continue;
+            }
+
+            const auto   samples    = values({x, y});
+            const double textHeight = double(samples.size() * mGlyphSize.height());
+            if (samples.isEmpty() || textHeight > cellHeight) {
+                continue;
+            }
+
+            // dark glyphs on bright pixels
+            const int shade = qGray(pixels.pixel(x, y)) > 128 ? 1 : 0;
+            double    top   = cell.center().y() - textHeight / 2.;
+            for (const auto sample : samples) {
+                const auto text  = formatValue(sample);
+                const auto width = double(text.size() * mGlyphSize.width());
+                if (width <= cellWidth) {
+                    double left = cell.center().x() - width / 2.;
+                    for (const auto c : text) {
+                        const auto index = static_cast<int>(glyphs.indexOf(c));
+                        if (index >= 0) {
+                            const QRectF glyph(index * mGlyphSize.width(),
+                                               shade * mGlyphSize.height(), mGlyphSize.width(),
+                                               mGlyphSize.height());
+                            const QPointF center(left + mGlyphSize.width() / 2.,
+                                                 top + mGlyphSize.height() / 2.);
+                            mFragments.append(QPainter::PixmapFragment::create(center, glyph));
+                        }
+                        left += mGlyphSize.width();
+                    }
+                }
+                top += mGlyphSize.height();
+            }
+        }
+    }
+
+    if (!mFragments.isEmpty()) {
+        painter->drawPixmapFragments(mFragments.constData(), static_cast<int>(mFragments.size()),
+                                     mAtlas);
+    }
+}
+
+void PixelGrid::buildAtlas() {
+    QFont font;
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(mFontSize);
+
+    const QFontMetrics fm(font);
+    mGlyphSize = QSize(fm.maxWidth(), fm.height());
+
+    const auto count = static_cast<int>(glyphs.size());
+
+    mAtlas = QPixmap(mGlyphSize.width() * count, mGlyphSize.height() * 2);
+    mAtlas.fill(Qt::transparent);
+
+    QPainter painter(&mAtlas);
+    painter.setFont(font);
+    const QColor shades[] = {QColor(235, 235, 235), QColor(20, 20, 20)};
+    for (int shade = 0; shade < 2; shade++) {
+        painter.setPen(shades[ shade ]);
+        for (int i = 0; i < count; i++) {
+            const QRect cell(i * mGlyphSize.width(), shade * mGlyphSize.height(),
+                             mGlyphSize.width(), mGlyphSize.height());
+            painter.drawText(cell, Qt::AlignCenter, glyphs.mid(i, 1));
+        }
+    }
+}
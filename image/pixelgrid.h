@@ -0,0 +1,47 @@
+#ifndef PIXELGRID_H
+#define PIXELGRID_H
+
+#include <QImage>
+#include <QLine>
+#include <QPainter>
+#include <QPixmap>
+#include <QVector>
+
+#include <functional>
+
+// pixel exact drawing at deep zoom: every source pixel is a solid block of screen pixels, a grid
+// separates the blocks and the samples are printed into cells that are large enough.
+// buffers and the glyph atlas are kept between paints, panning allocates nothing.
+class PixelGrid {
+public:
+    using ValueReader = std::function<QVector<double>(const QPoint &)>;
+
+    // `pixels` is RGB32 or premultiplied ARGB32 and drawn with the painter's world transform,
+    // which must only scale and translate. `values` reads the samples printed in a cell
+    void paint(QPainter *painter, const QImage &pixels, const QRect &source,
+               const ValueReader &values = {});
+
+private:
+    void magnify(const QImage &pixels, const QRect &target, const QSize &viewport,
+                 const QTransform &transform);
+    void paintGrid(QPainter *painter, const QRect &source, const QRect &target,
+                   const QTransform &transform);
+    void paintValues(QPainter *painter, const QImage &pixels, const QRect &source,
+                     const QRect &target, const QTransform &transform, const ValueReader &values);
+    void buildAtlas();
+
+private:
+    QImage         mBlocks;  // magnified source, one pixel per screen pixel, viewport sized
+    QVector<int>   mColumns; // source column of each screen column
+    QVector<QLine> mLines;
+
+    // glyphs in light and dark, one row each
+    QPixmap                           mAtlas;
+    QSize                             mGlyphSize;
+    QVector<QPainter::PixmapFragment> mFragments;
+
+    const double mValueScale = 40.; // smallest cell in screen pixels values are printed in
+    const int    mFontSize   = 10;  // pixels
+};
+
+#endif // PIXELGRID_H
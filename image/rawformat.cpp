@@ -0,0 +1,271 @@
+#include "rawformat.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QScopedPointer>
+#include <QVector>
+#include <QtEndian>
+
+namespace {
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// next whitespace separated token of a pnm header, skips comments
+QByteArray nextToken(const QByteArray &header, int &pos) {
+    while (pos < header.size()) {
+        const char c = header[ pos ];
+        if (c == '#') {
+            while (pos < header.size() && header[ pos ] != '\n') {
+                pos++;
+            }
+        } else if (isSpace(c)) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+
+    const int start = pos;
+    while (pos < header.size() && !isSpace(header[ pos ])) {
+        pos++;
+    }
+
+    return header.mid(start, pos - start);
+}
+
+RawLayout readPnmLayout(const QByteArray &header) {
+    int  pos   = 0;
+    auto magic = nextToken(header, pos);
+    if (magic != "P5" && magic != "P6") {
+        return {};
+    }
+
+    bool okWidth  = false;
+    bool okHeight = false;
+    bool okMax    = false;
+    auto width    = nextToken(header, pos).toInt(&okWidth);
+    auto height   = nextToken(header, pos).toInt(&okHeight);
+    auto maxValue = nextToken(header, pos).toInt(&okMax);
+    // exactly one whitespace between max value and pixels
+    if (!okWidth || !okHeight || !okMax || pos >= header.size() || width <= 0 || height <= 0) {
+        return {};
+    }
+
+    RawLayout layout;
+    layout.size      = {width, height};
+    layout.offset    = pos + 1;
+    layout.bigEndian = maxValue > 255;
+    if (magic == "P5") {
+        layout.format = maxValue > 255 ? QImage::Format_Grayscale16 : QImage::Format_Grayscale8;
+    } else if (maxValue <= 255) {
+        layout.format = QImage::Format_RGB888;
+    } else {
+        // 16bit rgb is not a packed qt format
+        return {};
+    }
+
+    layout.stride = qint64(width) * layout.bytesPerPixel();
+    return layout;
+}
+
+// numpy .npy: {'descr': '<u2', 'fortran_order': False, 'shape': (480, 640), }
+RawLayout readNpyLayout(const QByteArray &header) {
+    if (!header.startsWith("\x93NUMPY") || header.size() < 12) {
+        return {};
+    }
+
+    const auto *data        = header.constData();
+    int         dictStart   = 0;
+    int         dictLength  = 0;
+    const int   majorNumber = static_cast<uchar>(header[ 6 ]);
+    if (majorNumber == 1) {
+        dictStart  = 10;
+        dictLength = qFromLittleEndian<quint16>(data + 8);
+    } else if (majorNumber == 2 || majorNumber == 3) {
+        dictStart  = 12;
+        dictLength = static_cast<int>(qFromLittleEndian<quint32>(data + 8));
+    } else {
+        return {};
+    }
+
+    if (dictLength <= 0 || dictStart + dictLength > header.size()) {
+        return {};
+    }
+
+    const auto dict  = QString::fromLatin1(header.mid(dictStart, dictLength));
+    const auto descr = QRegularExpression(R"('descr'\s*:\s*'([<>|=]?)([a-z])(\d+)')").match(dict);
+    const auto order = QRegularExpression(R"('fortran_order'\s*:\s*(True|False))").match(dict);
+    const auto shape = QRegularExpression(R"('shape'\s*:\s*\(([^)]*)\))").match(dict);
+    if (!descr.hasMatch() || !order.hasMatch() || !shape.hasMatch() ||
+        order.captured(1) == "True" || descr.captured(2) != "u") {
+        return {};
+    }
+
+    QVector<int> dims;
+    for (const auto &dim : shape.captured(1).split(',')) {
+        if (!dim.trimmed().isEmpty()) {
+            dims.append(dim.trimmed().toInt());
+        }
+    }
+
+    const int channels = dims.size() == 3 ? dims[ 2 ] : 1;
+    const int depth    = descr.captured(3).toInt();
+    if ((dims.size() != 2 && dims.size() != 3) || dims[ 0 ] <= 0 || dims[ 1 ] <= 0) {
+        return {};
+    }
+
+    RawLayout layout;
+    if (depth == 1 && channels == 1) {
+        layout.format = QImage::Format_Grayscale8;
+    } else if (depth == 2 && channels == 1) {
+        layout.format    = QImage::Format_Grayscale16;
+        layout.bigEndian = descr.captured(1) == ">";
+    } else if (depth == 1 && channels == 3) {
+        layout.format = QImage::Format_RGB888;
+    } else if (depth == 1 && channels == 4) {
+        layout.format = QImage::Format_RGBA8888;
+    } else {
+        return {};
+    }
+
+    layout.size   = {dims[ 1 ], dims[ 0 ]};
+    layout.offset = dictStart + dictLength;
+    layout.stride = qint64(dims[ 1 ]) * layout.bytesPerPixel();
+    return layout;
+}
+
+// headerless .raw/.bin frame named like frame_640x480.raw, depth follows from the file size
+RawLayout readPlainLayout(const QFileInfo &info) {
+    const auto suffix = info.suffix().toLower();
+    if (suffix != "raw" && suffix != "bin") {
+        return {};
+    }
+
+    auto matches = QRegularExpression(R"((\d+)x(\d+))").globalMatch(info.completeBaseName());
+    QRegularExpressionMatch last;
+    while (matches.hasNext()) {
+        last = matches.next();
+    }
+
+    const auto width  = last.captured(1).toInt();
+    const auto height = last.captured(2).toInt();
+    if (width <= 0 || height <= 0) {
+        return {};
+    }
+
+    RawLayout layout;
+    layout.size = {width, height};
+    switch (info.size() / (qint64(width) * height)) {
+        case 1:
+            layout.format = QImage::Format_Grayscale8;
+            break;
+        case 2:
+            layout.format = QImage::Format_Grayscale16;
+            break;
+        case 3:
+            layout.format = QImage::Format_RGB888;
+            break;
+        case 4:
+            layout.format = QImage::Format_RGBA8888;
+            break;
+        default:
+            return {};
+    }
+
+    layout.stride = qint64(width) * layout.bytesPerPixel();
+    return layout;
+}
+} // namespace
+
+bool RawLayout::isValid() const {
+    return format != QImage::Format_Invalid && !size.isEmpty() && stride > 0;
+}
+
+int RawLayout::bytesPerPixel() const {
+    switch (format) {
+        case QImage::Format_Grayscale8:
+            return 1;
+        case QImage::Format_Grayscale16:
+            return 2;
+        case QImage::Format_RGB888:
+            return 3;
+        case QImage::Format_RGBA8888:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+RawLayout readRawLayout(const QString &filepath) {
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    const auto header = file.read(4096);
+    auto       layout = readPnmLayout(header);
+    if (!layout.isValid()) {
+        layout = readNpyLayout(header);
+    }
+    if (!layout.isValid()) {
+        layout = readPlainLayout(QFileInfo(filepath));
+    }
+
+    if (!layout.isValid() || layout.offset + layout.stride * layout.size.height() > file.size()) {
+        return {};
+    }
+
+    return layout;
+}
+
+QImage mapRawImage(const QString &filepath) {
+    const auto layout = readRawLayout(filepath);
+    // 16bit samples need aligned access
+    if (!layout.isValid() || (layout.bytesPerPixel() == 2 && layout.offset % 2 != 0)) {
+        return {};
+    }
+
+    QScopedPointer<QFile> file(new QFile(filepath));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    // closing the file unmaps it
+    const auto cleanup = [](void *info) { delete static_cast<QFile *>(info); };
+    const auto length  = layout.stride * layout.size.height();
+    const auto width   = layout.size.width();
+    const auto height  = layout.size.height();
+    const auto stride  = static_cast<int>(layout.stride);
+
+    QImage image;
+    if (!layout.bigEndian || QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+        const auto *data = file->map(layout.offset, length);
+        if (!data) {
+            return {};
+        }
+        image = QImage(static_cast<const uchar *>(data), width, height, stride, layout.format,
+                       cleanup, file.data());
+    } else {
+        // private copy on write mapping, samples are swapped in place
+        auto *data = file->map(layout.offset, length, QFileDevice::MapPrivateOption);
+        if (!data) {
+            return {};
+        }
+
+        auto *samples = reinterpret_cast<quint16 *>(data);
+        for (qint64 i = 0; i < length / 2; i++) {
+            samples[ i ] = qFromBigEndian(samples[ i ]);
+        }
+        image = QImage(data, width, height, stride, layout.format, cleanup, file.data());
+    }
+
+    if (image.isNull()) {
+        return {};
+    }
+
+    // owned by the image now
+    file.take();
+    return image;
+}
@@ -0,0 +1,26 @@
+#ifndef RAWFORMAT_H
+#define RAWFORMAT_H
+
+#include <QImage>
+#include <QString>
+
+// position of uncompressed pixel rows inside a file
+struct RawLayout {
+    QSize          size;
+    QImage::Format format    = QImage::Format_Invalid;
+    qint64         offset    = 0;     // first pixel in file
+    qint64         stride    = 0;     // bytes per row in file
+    bool           bigEndian = false; // 16bit samples stored most significant byte first
+
+    bool isValid() const;
+    int  bytesPerPixel() const;
+};
+
+// binary PGM(P5)/PPM(P6), numpy .npy and headerless .raw/.bin named like frame_640x480.raw,
+// invalid layout for anything else
+RawLayout readRawLayout(const QString &filepath);
+
+// memory mapped pixels of an uncompressed file, unmapped when the last image copy goes away
+QImage mapRawImage(const QString &filepath);
+
+#endif // RAWFORMAT_H
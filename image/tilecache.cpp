@@ -0,0 +1,245 @@
+#include "tilecache.h"
+#include "displayformat.h"
+#include "windowlevel.h"
+
+#include <climits>
+
+TileCache::TileCache(QObject *parent)
+    : QObject(parent)
+    , mState(new State)
+    , mMemory(MemoryBudget::Tiles, 1, [ this ](qint64 bytes) { trim(bytes); }) {
+    mCache.setMaxCost(256 * 1024);
+    mWindowed.setMaxCost(mCache.maxCost() / 4);
+}
+
+TileCache::~TileCache() {
+    // running decodes post to this object, wait for them before it goes away
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+void TileCache::setSource(const QSharedPointer<TileSource> &source) {
+    mPool.clear();
+    mCache.clear();
+    mWindowed.clear();
+    updateUsage();
+    mState.reset(new State);
+    mSource          = source;
+    mAutoWindow      = true;
+    mAutoWindowLevel = -1;
+}
+
+QSharedPointer<TileSource> TileCache::source() const {
+    return mSource;
+}
+
+void TileCache::setMaxCost(int kilobytes) {
+    mCache.setMaxCost(kilobytes);
+    mWindowed.setMaxCost(kilobytes / 4);
+    updateUsage();
+}
+
+int TileCache::maxCost() const {
+    return mCache.maxCost();
+}
+
+int TileCache::tileSize() const {
+    return mTileSize;
+}
+
+int TileCache::levelCount() const {
+    if (!mSource) {
+        return 0;
+    }
+
+    const auto size    = mSource->size();
+    const auto longest = qMax(size.width(), size.height());
+    int        count   = 1;
+    while ((qint64(mTileSize) << (count - 1)) < longest) {
+        count++;
+    }
+
+    return count;
+}
+
+int TileCache::levelForScale(double scale) const {
+    // coarsest level that still has a texel per screen pixel
+    const int count = levelCount();
+    int       level = 0;
+    while (level + 1 < count && scale * (1 << (level + 1)) <= 1.) {
+        level++;
+    }
+
+    return level;
+}
+
+QRect TileCache::tileRect(int level, int column, int row) const {
+    if (!mSource) {
+        return {};
+    }
+
+    const int span = mTileSize << level;
+    return QRect(column * span, row * span, span, span).intersected(QRect({0, 0}, mSource->size()));
+}
+
+void TileCache::beginFrame() {
+    mState->frame++;
+}
+
+QImage TileCache::tile(int level, int column, int row) {
+    const auto k = key(level, column, row);
+    if (auto *cached = mCache.object(k)) {
+        mStats.hits++;
+        return windowed(k, *cached);
+    }
+    mStats.misses++;
+
+    const auto rect = tileRect(level, column, row);
+    if (!mSource || rect.isEmpty()) {
+        return {};
+    }
+
+    {
+        QMutexLocker locker(&mState->mutex);
+        const bool   queued = mState->wanted.contains(k);
+        mState->wanted[ k ] = mState->frame;
+        if (queued) {
+            return {};
+        }
+    }
+
+    const int  round = (1 << level) - 1;
+    const auto scaledSize =
+        QSize((rect.width() + round) >> level, (rect.height() + round) >> level);
+    auto state  = mState;
+    auto source = mSource;
+    mPool.start([ this, state, source, k, rect, scaledSize ]() {
+        {
+            // scrolled out of view before a worker got to it
+            QMutexLocker locker(&state->mutex);
+            if (state->wanted.value(k) + 1 < state->frame) {
+                state->wanted.remove(k);
+                return;
+            }
+        }
+
+        // converted here so painting never converts, high bit depth tiles are windowed later
+        auto image = source->read(rect, scaledSize);
+        if (!isHighDepth(image.format())) {
+            image = toDisplayFormat(image);
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [ this, state, k, image ]() {
+                if (state == mState) {
+                    onDecoded(k, image);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+
+    return {};
+}
+
+QImage TileCache::cachedTile(int level, int column, int row) {
+    const auto k      = key(level, column, row);
+    auto      *cached = mCache.object(k);
+    return cached ? windowed(k, *cached) : QImage();
+}
+
+TileCache::Stats TileCache::stats() const {
+    return mStats;
+}
+
+void TileCache::setWindow(double low, double high) {
+    mAutoWindow = false;
+    mWindowLow  = low;
+    mWindowHigh = high;
+    mWindowed.clear();
+    updateUsage();
+    emit tileReady();
+}
+
+void TileCache::resetWindow() {
+    mAutoWindow      = true;
+    mAutoWindowLevel = -1;
+
+    // sample again from the coarsest tile already decoded
+    for (int level = levelCount() - 1; level >= 0; level--) {
+        const auto k = key(level, 0, 0);
+        if (auto *cached = mCache.object(k)) {
+            onDecoded(k, *cached);
+            return;
+        }
+    }
+}
+
+QPair<double, double> TileCache::window() const {
+    return {mWindowLow, mWindowHigh};
+}
+
+quint64 TileCache::key(int level, int column, int row) {
+    return (quint64(level) << 48) | (quint64(row) << 24) | quint64(column);
+}
+
+void TileCache::onDecoded(quint64 tileKey, const QImage &tile) {
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->wanted.remove(tileKey);
+    }
+
+    if (tile.isNull()) {
+        return;
+    }
+
+    // coarser tiles see more of the image, the window is sampled again from them
+    const int level = static_cast<int>(tileKey >> 48);
+    if (mAutoWindow && isHighDepth(tile.format()) && level > mAutoWindowLevel) {
+        const auto range = sampleRange(tile);
+        mAutoWindowLevel = level;
+        mWindowLow       = range.first;
+        mWindowHigh      = range.second;
+        mWindowed.clear();
+    }
+
+    if (!mCache.contains(tileKey)) {
+        const auto cost = static_cast<int>(qMax<qint64>(1, tile.sizeInBytes() / 1024));
+        mCache.insert(tileKey, new QImage(tile), cost);
+        updateUsage();
+    }
+    emit tileReady();
+}
+
+QImage TileCache::windowed(quint64 tileKey, const QImage &tile) {
+    if (!isHighDepth(tile.format())) {
+        return tile;
+    }
+
+    if (auto *cached = mWindowed.object(tileKey)) {
+        return *cached;
+    }
+
+    auto       image = applyWindow(tile, mWindowLow, mWindowHigh);
+    const auto cost  = static_cast<int>(qMax<qint64>(1, image.sizeInBytes() / 1024));
+    mWindowed.insert(tileKey, new QImage(image), cost);
+    updateUsage();
+    return image;
+}
+
+void TileCache::trim(qint64 bytes) {
+    // shrinking the limit drops the least recently used tiles first
+    auto kilobytes = static_cast<int>(qMin<qint64>(bytes / 1024 + 1, INT_MAX));
+    for (auto *cache : {&mWindowed, &mCache}) {
+        const int maxCost = cache->maxCost();
+        const int removed = qMin(kilobytes, cache->totalCost());
+        cache->setMaxCost(cache->totalCost() - removed);
+        cache->setMaxCost(maxCost);
+        kilobytes -= removed;
+    }
+
+    updateUsage();
+}
+
+void TileCache::updateUsage() {
+    mMemory.setUsage((qint64(mCache.totalCost()) + mWindowed.totalCost()) * 1024);
+}
@@ -0,0 +1,88 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include "memorybudget.h"
+#include "tilesource.h"
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QThreadPool>
+
+#include <atomic>
+
+// bounded LRU cache of decoded tiles, missing tiles are decoded in background.
+// level n tiles cover tileSize * 2^n source pixels.
+class TileCache : public QObject {
+    Q_OBJECT
+public:
+    // lookups through tile(), a miss is a tile still decoding
+    struct Stats {
+        quint64 hits   = 0;
+        quint64 misses = 0;
+    };
+
+    explicit TileCache(QObject *parent = nullptr);
+    ~TileCache() override;
+
+    void                       setSource(const QSharedPointer<TileSource> &source);
+    QSharedPointer<TileSource> source() const;
+
+    void setMaxCost(int kilobytes);
+    int  maxCost() const;
+    int  tileSize() const;
+
+    int   levelCount() const;
+    int   levelForScale(double scale) const;
+    QRect tileRect(int level, int column, int row) const;
+
+    // start of a paint pass, requests not repeated since the previous pass are dropped
+    void beginFrame();
+    // cached tile, a missing tile is queued for decoding
+    QImage tile(int level, int column, int row);
+    // cached tile without queueing
+    QImage cachedTile(int level, int column, int row);
+    Stats  stats() const;
+
+    // display window of high bit depth sources, follows the coarsest decoded tile until set
+    void                  setWindow(double low, double high);
+    void                  resetWindow();
+    QPair<double, double> window() const;
+
+signals:
+    void tileReady();
+
+private:
+    static quint64 key(int level, int column, int row);
+
+    void   onDecoded(quint64 tileKey, const QImage &tile);
+    QImage windowed(quint64 tileKey, const QImage &tile);
+    void   trim(qint64 bytes);
+    void   updateUsage();
+
+private:
+    struct State {
+        QMutex                  mutex;
+        QHash<quint64, quint64> wanted; // key -> last frame it was requested
+        std::atomic<quint64>    frame{0};
+    };
+
+    QSharedPointer<TileSource> mSource;
+    QSharedPointer<State>      mState;
+    QCache<quint64, QImage>    mCache;
+    QCache<quint64, QImage>    mWindowed; // 8bit copies of high bit depth tiles
+    QThreadPool                mPool;
+    BudgetClient               mMemory;
+    Stats                      mStats;
+
+    double mWindowLow       = 0;
+    double mWindowHigh      = 255;
+    bool   mAutoWindow      = true;
+    int    mAutoWindowLevel = -1; // level the automatic window was sampled from
+
+    const int mTileSize = 512;
+};
+
+#endif // TILECACHE_H
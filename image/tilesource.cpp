@@ -0,0 +1,117 @@
+#include "tilesource.h"
+
+#include <QFile>
+#include <QImageReader>
+#include <QtEndian>
+
+#include <cstring>
+
+QSharedPointer<TileSource> TileSource::open(const QString &filepath, qint64 minPixels) {
+    auto isLarge = [ minPixels ](const QSize &size) {
+        return qint64(size.width()) * size.height() >= minPixels;
+    };
+
+    auto layout = readRawLayout(filepath);
+    if (layout.isValid()) {
+        if (!isLarge(layout.size)) {
+            return {};
+        }
+        return QSharedPointer<TileSource>(new RawTileSource(filepath, layout));
+    }
+
+    QSharedPointer<ReaderTileSource> source(new ReaderTileSource(filepath));
+    if (!source->isValid() || !isLarge(source->size())) {
+        return {};
+    }
+
+    return source;
+}
+
+ReaderTileSource::ReaderTileSource(QString filepath)
+    : mFilepath(std::move(filepath)) {
+    QImageReader reader(mFilepath);
+    if (!reader.supportsOption(QImageIOHandler::ClipRect) ||
+        !reader.supportsOption(QImageIOHandler::Size)) {
+        return;
+    }
+
+    mSize   = reader.size();
+    mFormat = reader.imageFormat();
+}
+
+QSize ReaderTileSource::size() const {
+    return mSize;
+}
+
+QImage::Format ReaderTileSource::format() const {
+    return mFormat;
+}
+
+QImage ReaderTileSource::read(const QRect &rect, const QSize &scaledSize) const {
+    // clip is applied before scaling, plugins such as jpeg scale while decoding
+    QImageReader reader(mFilepath);
+    reader.setClipRect(rect);
+    if (scaledSize != rect.size()) {
+        reader.setScaledSize(scaledSize);
+    }
+
+    return reader.read();
+}
+
+bool ReaderTileSource::isValid() const {
+    return mSize.isValid() && !mSize.isEmpty();
+}
+
+RawTileSource::RawTileSource(QString filepath, const RawLayout &layout)
+    : mFilepath(std::move(filepath))
+    , mLayout(layout) {}
+
+QSize RawTileSource::size() const {
+    return mLayout.size;
+}
+
+QImage::Format RawTileSource::format() const {
+    return mLayout.format;
+}
+
+QImage RawTileSource::read(const QRect &rect, const QSize &scaledSize) const {
+    QFile file(mFilepath);
+    if (!file.open(QIODevice::ReadOnly) || rect.isEmpty() || scaledSize.isEmpty()) {
+        return {};
+    }
+
+    QImage tile(scaledSize, mLayout.format);
+    if (tile.isNull()) {
+        return {};
+    }
+
+    const int  bpp = mLayout.bytesPerPixel();
+    QByteArray row(rect.width() * bpp, Qt::Uninitialized);
+    for (int y = 0; y < scaledSize.height(); y++) {
+        // nearest row/column, coarse levels skip the rows in between
+        const auto srcY = rect.y() + qint64(y) * rect.height() / scaledSize.height();
+        if (!file.seek(mLayout.offset + srcY * mLayout.stride + qint64(rect.x()) * bpp) ||
+            file.read(row.data(), row.size()) != row.size()) {
+            return {};
+        }
+
+        auto *out = tile.scanLine(y);
+        if (scaledSize.width() == rect.width()) {
+            memcpy(out, row.constData(), static_cast<size_t>(row.size()));
+        } else {
+            for (int x = 0; x < scaledSize.width(); x++) {
+                const auto srcX = qint64(x) * rect.width() / scaledSize.width();
+                memcpy(out + x * bpp, row.constData() + srcX * bpp, static_cast<size_t>(bpp));
+            }
+        }
+
+        if (mLayout.bigEndian && bpp == 2) {
+            auto *samples = reinterpret_cast<quint16 *>(out);
+            for (int x = 0; x < scaledSize.width(); x++) {
+                samples[ x ] = qFromBigEndian(samples[ x ]);
+            }
+        }
+    }
+
+    return tile;
+}
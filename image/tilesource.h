@@ -0,0 +1,56 @@
+#ifndef TILESOURCE_H
+#define TILESOURCE_H
+
+#include "rawformat.h"
+
+#include <QImage>
+#include <QSharedPointer>
+
+// image that decodes regions on demand instead of all pixels at once.
+// read() is called from worker threads and must be reentrant.
+class TileSource {
+public:
+    virtual ~TileSource() = default;
+
+    virtual QSize          size() const   = 0;
+    virtual QImage::Format format() const = 0;
+    // decode `rect` of the source resized to `scaledSize`
+    virtual QImage read(const QRect &rect, const QSize &scaledSize) const = 0;
+
+    // tiled source for images of at least `minPixels` pixels, null when the file has to be
+    // decoded as a whole
+    static QSharedPointer<TileSource> open(const QString &filepath, qint64 minPixels);
+};
+
+// formats whose qt plugin decodes a clip rect without decoding the whole image
+class ReaderTileSource : public TileSource {
+public:
+    explicit ReaderTileSource(QString filepath);
+
+    QSize          size() const override;
+    QImage::Format format() const override;
+    QImage         read(const QRect &rect, const QSize &scaledSize) const override;
+
+    bool isValid() const;
+
+private:
+    QString        mFilepath;
+    QSize          mSize;
+    QImage::Format mFormat = QImage::Format_Invalid;
+};
+
+// uncompressed files, reads the covered row strips only
+class RawTileSource : public TileSource {
+public:
+    RawTileSource(QString filepath, const RawLayout &layout);
+
+    QSize          size() const override;
+    QImage::Format format() const override;
+    QImage         read(const QRect &rect, const QSize &scaledSize) const override;
+
+private:
+    QString   mFilepath;
+    RawLayout mLayout;
+};
+
+#endif // TILESOURCE_H
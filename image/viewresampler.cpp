@@ -0,0 +1,54 @@
+#include "viewresampler.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+ViewResampler::ViewResampler(QObject *parent)
+    : QObject(parent) {
+    connect(&mWatcher, &QFutureWatcher<QImage>::finished, this, [ this ]() {
+        if (mPending.target.isNull()) {
+            return;
+        }
+
+        mResult       = mPending;
+        mResult.image = mWatcher.result();
+        mPending      = View();
+        emit ready();
+    });
+}
+
+void ViewResampler::request(const QImage &image, const QRect &rect, const QRectF &target,
+                            qreal ratio, const QTransform &transform, const QRect &source) {
+    mPending.target    = target;
+    mPending.transform = transform;
+    mPending.source    = source;
+
+    // smooth scaling averages all covered pixels when shrinking
+    const auto size = (target.size() * ratio).toSize();
+    mWatcher.setFuture(QtConcurrent::run([ image, rect, size, ratio ]() {
+        auto scaled = image.copy(rect).scaled(size, Qt::IgnoreAspectRatio,
+                                              Qt::SmoothTransformation);
+        scaled.setDevicePixelRatio(ratio);
+        return scaled;
+    }));
+}
+
+ViewResampler::View ViewResampler::result(const QTransform &transform,
+                                          const QRect &source) const {
+    // a partial repaint of the view asks for a part of it
+    if (mResult.image.isNull() || mResult.transform != transform ||
+        !mResult.source.contains(source)) {
+        return {};
+    }
+
+    return mResult;
+}
+
+bool ViewResampler::isPending(const QTransform &transform, const QRect &source) const {
+    return !mPending.target.isNull() && mPending.transform == transform &&
+           mPending.source == source;
+}
+
+void ViewResampler::clear() {
+    mPending = View();
+    mResult  = View();
+}
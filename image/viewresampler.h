@@ -0,0 +1,42 @@
+#ifndef VIEWRESAMPLER_H
+#define VIEWRESAMPLER_H
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QObject>
+#include <QRectF>
+#include <QTransform>
+
+// the visible part of an image area averaged down to the exact view scale in background. the
+// fast mip level drawing is replaced by it once the view stopped changing, a changed view
+// falls back to the fast path until it is idle again.
+class ViewResampler : public QObject {
+    Q_OBJECT
+public:
+    struct View {
+        QImage     image;     // device pixel ratio set
+        QRectF     target;    // widget area it covers, drawn without a transform
+        QTransform transform; // view it was made for
+        QRect      source;    // image area of that view
+    };
+
+    explicit ViewResampler(QObject *parent = nullptr);
+
+    // `rect` of `image` scaled to `target` at device pixel `ratio`, replaces a pending request
+    void request(const QImage &image, const QRect &rect, const QRectF &target, qreal ratio,
+                 const QTransform &transform, const QRect &source);
+    // null image unless it was made for this view
+    View result(const QTransform &transform, const QRect &source) const;
+    bool isPending(const QTransform &transform, const QRect &source) const;
+    void clear();
+
+signals:
+    void ready();
+
+private:
+    QFutureWatcher<QImage> mWatcher;
+    View                   mPending; // image is null
+    View                   mResult;
+};
+
+#endif // VIEWRESAMPLER_H
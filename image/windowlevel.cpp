@@ -0,0 +1,258 @@
+#include "windowlevel.h"
+#include "displayformat.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WINDOWLEVEL_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+int samplesPerPixel(QImage::Format format) {
+    return format == QImage::Format_Grayscale16 ? 1 : 4;
+}
+
+bool isFloat(QImage::Format format) {
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 2, 0))
+    return format == QImage::Format_RGBX32FPx4 || format == QImage::Format_RGBA32FPx4 ||
+           format == QImage::Format_RGBA32FPx4_Premultiplied;
+#else
+    Q_UNUSED(format)
+    return false;
+#endif
+}
+
+bool isPremultiplied(QImage::Format format) {
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 2, 0))
+    if (format == QImage::Format_RGBA32FPx4_Premultiplied) {
+        return true;
+    }
+#endif
+    return format == QImage::Format_RGBA64_Premultiplied;
+}
+
+// premultiplied rgba to straight floats, the window applies to the colors. alpha is scaled to
+// [0, 1] as in float images
+template <class T>
+void unpremultiply(const T *src, float *dst, int pixels, float opaque) {
+    for (int x = 0; x < pixels; x++) {
+        const auto *p     = src + x * 4;
+        auto       *q     = dst + x * 4;
+        const auto  alpha = static_cast<float>(p[ 3 ]);
+        const float scale = alpha > 0.f ? opaque / alpha : 0.f;
+        q[ 0 ]            = static_cast<float>(p[ 0 ]) * scale;
+        q[ 1 ]            = static_cast<float>(p[ 1 ]) * scale;
+        q[ 2 ]            = static_cast<float>(p[ 2 ]) * scale;
+        q[ 3 ]            = alpha / opaque;
+    }
+}
+
+// rounds half up as windowLane does, a sample gives the same byte in the tail of a row.
+// nan is 0 there too
+uchar clampSample(float value) {
+    if (!(value > 0.f)) {
+        return 0;
+    }
+    if (value >= 255.f) {
+        return 255;
+    }
+    return static_cast<uchar>(value + 0.5f);
+}
+
+#ifdef WINDOWLEVEL_SSE2
+// four windowed floats to four saturated bytes in the low lane
+__m128i windowLane(__m128 value, __m128 low, __m128 scale) {
+    value = _mm_mul_ps(_mm_sub_ps(value, low), scale);
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(255.f));
+    return _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(.5f)));
+}
+#endif
+
+void windowSamples(const quint16 *src, uchar *dst, int count, float low, float scale) {
+    int i = 0;
+#ifdef WINDOWLEVEL_SSE2
+    const auto lowV   = _mm_set1_ps(low);
+    const auto scaleV = _mm_set1_ps(scale);
+    const auto zero   = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+
+        const auto a0 = windowLane(_mm_cvtepi32_ps(_mm_unpacklo_epi16(a, zero)), lowV, scaleV);
+        const auto a1 = windowLane(_mm_cvtepi32_ps(_mm_unpackhi_epi16(a, zero)), lowV, scaleV);
+        const auto b0 = windowLane(_mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zero)), lowV, scaleV);
+        const auto b1 = windowLane(_mm_cvtepi32_ps(_mm_unpackhi_epi16(b, zero)), lowV, scaleV);
+
+        const auto packed = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(b0, b1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+#endif
+    for (; i < count; i++) {
+        dst[ i ] = clampSample((static_cast<float>(src[ i ]) - low) * scale);
+    }
+}
+
+void windowSamples(const float *src, uchar *dst, int count, float low, float scale) {
+    int i = 0;
+#ifdef WINDOWLEVEL_SSE2
+    const auto lowV   = _mm_set1_ps(low);
+    const auto scaleV = _mm_set1_ps(scale);
+    for (; i + 16 <= count; i += 16) {
+        const auto a0 = windowLane(_mm_loadu_ps(src + i), lowV, scaleV);
+        const auto a1 = windowLane(_mm_loadu_ps(src + i + 4), lowV, scaleV);
+        const auto b0 = windowLane(_mm_loadu_ps(src + i + 8), lowV, scaleV);
+        const auto b1 = windowLane(_mm_loadu_ps(src + i + 12), lowV, scaleV);
+
+        const auto packed = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(b0, b1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+#endif
+    for (; i < count; i++) {
+        dst[ i ] = clampSample((src[ i ] - low) * scale);
+    }
+}
+} // namespace
+
+bool isHighDepth(QImage::Format format) {
+    return format == QImage::Format_Grayscale16 || format == QImage::Format_RGBX64 ||
+           format == QImage::Format_RGBA64 || format == QImage::Format_RGBA64_Premultiplied ||
+           isFloat(format);
+}
+
+void applyWindow(const QImage &src, const QRect &srcRect, QImage &dst, const QPoint &dstPos,
+                 double low, double high) {
+    const auto rect = srcRect.intersected(src.rect());
+    if (rect.isEmpty() || !isHighDepth(src.format())) {
+        return;
+    }
+
+    const int  spp           = samplesPerPixel(src.format());
+    const bool real          = isFloat(src.format());
+    const bool premultiplied = isPremultiplied(src.format());
+    const auto lowF          = static_cast<float>(low);
+    const auto scale         = static_cast<float>(255. / std::max(high - low, 1e-12));
+    const int  count         = rect.width() * spp;
+
+    // samples are windowed into a row of bytes, then packed into display pixels. premultiplied
+    // ones are made straight first, the colors would be windowed with alpha applied otherwise
+    QVector<uchar> row(count);
+    QVector<float> straight(premultiplied ? count : 0);
+    auto          *out = row.data();
+    for (int y = 0; y < rect.height(); y++) {
+        const auto *line = src.constScanLine(rect.y() + y);
+        if (premultiplied && real) {
+            unpremultiply(reinterpret_cast<const float *>(line) + rect.x() * spp, straight.data(),
+                          rect.width(), 1.f);
+        } else if (premultiplied) {
+            unpremultiply(reinterpret_cast<const quint16 *>(line) + rect.x() * spp,
+                          straight.data(), rect.width(), 65535.f);
+        }
+
+        if (real || premultiplied) {
+            const auto *samples = premultiplied
+                                      ? straight.constData()
+                                      : reinterpret_cast<const float *>(line) + rect.x() * spp;
+            windowSamples(samples, out, count, lowF, scale);
+
+            // alpha is not windowed
+            for (int x = 0; x < rect.width() && spp == 4; x++) {
+                out[ x * 4 + 3 ] = clampSample(samples[ x * 4 + 3 ] * 255.f);
+            }
+        } else {
+            const auto *samples = reinterpret_cast<const quint16 *>(line) + rect.x() * spp;
+            windowSamples(samples, out, count, lowF, scale);
+
+            for (int x = 0; x < rect.width() && spp == 4; x++) {
+                out[ x * 4 + 3 ] = static_cast<uchar>(samples[ x * 4 + 3 ] >> 8);
+            }
+        }
+
+        auto *pixels = reinterpret_cast<QRgb *>(dst.scanLine(dstPos.y() + y)) + dstPos.x();
+        if (spp == 1) {
+            for (int x = 0; x < rect.width(); x++) {
+                pixels[ x ] = 0xff000000u | (0x010101u * out[ x ]);
+            }
+        } else {
+            for (int x = 0; x < rect.width(); x++) {
+                const auto *p = out + x * 4;
+                pixels[ x ]   = qPremultiply(qRgba(p[ 0 ], p[ 1 ], p[ 2 ], p[ 3 ]));
+            }
+        }
+    }
+}
+
+QImage applyWindow(const QImage &src, double low, double high) {
+    if (!isHighDepth(src.format())) {
+        return src;
+    }
+
+    QImage dst(src.size(), displayFormat(src));
+    applyWindow(src, src.rect(), dst, {0, 0}, low, high);
+    return dst;
+}
+
+QPair<double, double> sampleRange(const QImage &image) {
+    if (image.isNull() || !isHighDepth(image.format())) {
+        return {0., 255.};
+    }
+
+    // about a million samples is enough for a display window
+    const int spp      = samplesPerPixel(image.format());
+    const int channels = std::min(spp, 3);
+    const int rows     = std::max(1, (1 << 20) / std::max(1, image.width()));
+    const int rowStep  = std::max(1, image.height() / rows);
+
+    double low  = std::numeric_limits<double>::max();
+    double high = std::numeric_limits<double>::lowest();
+    for (int y = 0; y < image.height(); y += rowStep) {
+        const auto *line = image.constScanLine(y);
+        for (int x = 0; x < image.width(); x++) {
+            for (int c = 0; c < channels; c++) {
+                const double value =
+                    isFloat(image.format())
+                        ? double(reinterpret_cast<const float *>(line)[ x * spp + c ])
+                        : double(reinterpret_cast<const quint16 *>(line)[ x * spp + c ]);
+                low  = std::min(low, value);
+                high = std::max(high, value);
+            }
+        }
+    }
+
+    if (high <= low) {
+        high = low + 1.;
+    }
+
+    return {low, high};
+}
+
+QVector<double> pixelValues(const QImage &image, const QPoint &pos) {
+    if (!image.valid(pos)) {
+        return {};
+    }
+
+    const auto *line = image.constScanLine(pos.y());
+    switch (image.format()) {
+        case QImage::Format_Grayscale8:
+            return {double(line[ pos.x() ])};
+        case QImage::Format_Grayscale16:
+            return {double(reinterpret_cast<const quint16 *>(line)[ pos.x() ])};
+        case QImage::Format_RGBX64:
+        case QImage::Format_RGBA64:
+        case QImage::Format_RGBA64_Premultiplied: {
+            const auto *p = reinterpret_cast<const quint16 *>(line) + pos.x() * 4;
+            return {double(p[ 0 ]), double(p[ 1 ]), double(p[ 2 ])};
+        }
+        default:
+            break;
+    }
+
+    if (isFloat(image.format())) {
+        const auto *p = reinterpret_cast<const float *>(line) + pos.x() * 4;
+        return {double(p[ 0 ]), double(p[ 1 ]), double(p[ 2 ])};
+    }
+
+    const auto color = image.pixelColor(pos);
+    return {double(color.red()), double(color.green()), double(color.blue())};
+}
@@ -0,0 +1,23 @@
+#ifndef WINDOWLEVEL_H
+#define WINDOWLEVEL_H
+
+#include <QImage>
+#include <QPair>
+#include <QVector>
+
+// display of high bit depth (16bit/float) images: samples in [low, high] map linearly to 0..255
+
+bool isHighDepth(QImage::Format format);
+
+// window `srcRect` of `src` into `dst` at `dstPos`, dst is RGB32 or premultiplied ARGB32
+void   applyWindow(const QImage &src, const QRect &srcRect, QImage &dst, const QPoint &dstPos,
+                   double low, double high);
+QImage applyWindow(const QImage &src, double low, double high);
+
+// smallest and largest sample, rows are sampled on large images
+QPair<double, double> sampleRange(const QImage &image);
+
+// native samples of a pixel, one value for gray images and r,g,b otherwise
+QVector<double> pixelValues(const QImage &image, const QPoint &pos);
+
+#endif // WINDOWLEVEL_H
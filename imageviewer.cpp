@@ -1,18 +1,34 @@
 #include "imageviewer.h"
+#include "batch/batchrenderer.h"
+#include "image/imageloader.h"
 #include "label/imagelabel.h"
 #include "types.h"
 
+#ifdef VIEWER_OPENGL
+#include "glcanvas.h"
+#endif
+
 #include <QApplication>
 #include <QDebug>
 #include <QFontMetrics>
 #include <QKeyEvent>
 #include <QMenu>
 #include <QPainter>
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
 ImageViewer::ImageViewer(QWidget *parent)
-    : QWidget{parent} {
+    : QWidget{parent}
+    , mLayerMemory(MemoryBudget::LabelLayers, 1, [ this ](qint64) {
+        // drawn again on the next paint, only for the visible categories
+        for (auto *category : mLayers.keys()) {
+            disconnect(category, nullptr, this, nullptr);
+        }
+        mLayers.clear();
+        mLayerMemory.setUsage(0);
+        update();
+    }) {
     setMouseTracking(true);
 
     setBackgroundRole(QPalette::Mid);
@@ -20,18 +36,65 @@ ImageViewer::ImageViewer(QWidget *parent)
     setFocusPolicy(Qt::ClickFocus);
 
     mBackground = QImage(":/mask.png");
+
+    // decode in background, keep showing the current image until the new one is ready
+    mLoader = new ImageLoader(this);
+    connect(mLoader, &ImageLoader::progress, this, &ImageViewer::loadProgress);
+    connect(mLoader, &ImageLoader::loaded, this, [ this ](const QImage &img, const QString &path) {
+        setImage(img);
+        emit loadFinished(path, true);
+    });
+    connect(mLoader, &ImageLoader::failed, this,
+            [ this ](const QString &path) { emit loadFinished(path, false); });
+    connect(mLoader, &ImageLoader::canceled, this, &ImageViewer::loadCanceled);
+
+    // a view that stopped changing is resampled sharply in background
+    mIdleTimer.setSingleShot(true);
+    mIdleTimer.setInterval(mIdleDelay);
+    connect(&mIdleTimer, &QTimer::timeout, this, [ this ]() {
+        if (mImageLabel) {
+            mImageLabel->sharpen();
+        }
+    });
+
+    // labels composed in background, painted when ready
+    connect(&mSceneRenderer, &SceneRenderer::frameReady, this,
+            QOverload<>::of(&ImageViewer::update));
+
+    if (qEnvironmentVariableIntValue("VIEWER_OPENGL") > 0) {
+        setOpenGL(true);
+    }
 }
 
 void ImageViewer::paintEvent(QPaintEvent *event) {
-    Q_UNUSED(event)
+    // the canvas covers the widget and always repaints all of it
+    if (mCanvas) {
+        mCanvas->update();
+        return;
+    }
+
     QPainter painter(this);
+    paint(painter, event->region());
+}
 
-    painter.fillRect(rect(), QBrush(mBackground));
+void ImageViewer::paint(QPainter &painter, const QRegion &region) {
+    // partial repaints only redraw what changed under the mouse, frames wait for a full one
+    const bool full = QRegion(rect()).subtracted(region).isEmpty();
+    mPaintStats.beginFrame();
+
+    // newest frame of a stream, the ones that arrived since the last paint are dropped
+    auto frame = full ? mFrames.take() : QImage();
+    if (!frame.isNull()) {
+        showFrame(frame);
+    }
+
+    painter.fillRect(region.boundingRect(), QBrush(mBackground));
     painter.save();
+    mPaintStats.endStage(PaintStats::Background);
 
     PaintInfo info;
     info.painter    = &painter;
-    info.size       = mImageLabel ? mImageLabel->image().size() : QSizeF{0, 0};
+    info.size       = mImageLabel ? mImageLabel->size() : QSizeF{0, 0};
     info.worldScale = getWorldScale();
     info.offset     = mImageOriginOffset;
 
@@ -39,29 +102,40 @@ void ImageViewer::paintEvent(QPaintEvent *event) {
     QTransform halfPixel;
     halfPixel.translate(mImageOriginOffset.x(), mImageOriginOffset.y());
     painter.setTransform(halfPixel * getWorldTransform());
+    if (painter.worldTransform() != mIdleView) {
+        mIdleView = painter.worldTransform();
+        mIdleTimer.start();
+    }
     if (mImageLabel && mImageLabel->category()->visible()) {
+        const auto before = mImageLabel->tileCache()->stats();
         mImageLabel->onPaint(info);
+        const auto after = mImageLabel->tileCache()->stats();
+        mPaintStats.count(PaintStats::Tiles, after.hits - before.hits,
+                          after.misses - before.misses);
     }
+    mPaintStats.endStage(PaintStats::Image);
 
     // Setup world transform matrix
     painter.setTransform(getWorldTransform());
     painter.setRenderHint(QPainter::Antialiasing);
-    foreach (auto &label, mLabels) {
-        if (!label->category()->visible()) {
-            continue;
-        }
-        label->onPaint(info);
+    syncTouched();
+    if (mDensityScale > 0. && getWorldScale() < mDensityScale) {
+        mDensity.paint(&painter, getWorldScale());
+    } else {
+        paintLayers(painter, info);
     }
+    mPaintStats.endStage(PaintStats::Labels);
 
-    foreach (auto &editor, mEditors) {
-        if (!editor->category()->visible()) {
-            continue;
-        }
-        editor->onPaint(info);
+    if (mSelectedEditor && mSelectedEditor->category()->visible() &&
+        (full || region.intersects(screenRect(*mSelectedEditor)))) {
+        mSelectedEditor->onPaint(info);
     }
+    mPaintStats.endStage(PaintStats::Editor);
 
     painter.restore();
     displayInfo(painter);
+    mPaintStats.endStage(PaintStats::Overlay);
+    mPaintStats.endFrame();
 }
 
 void ImageViewer::mousePressEvent(QMouseEvent *event) {
@@ -73,30 +147,30 @@ void ImageViewer::mousePressEvent(QMouseEvent *event) {
 
     if (mInPixelSelect) {
         auto pos = mMousePos.toPoint();
-        if (!mImageLabel || mImageLabel->image().isNull()) {
+        if (!mImageLabel || mImageLabel->isNull()) {
             mSelectedColor = QColor();
+            mSelectedValues.clear();
         } else {
-            // check valid position
-            const auto &img = mImageLabel->image();
-            if (pos.x() >= 0 && pos.x() < img.width() && pos.y() >= 0 && pos.y() < img.height()) {
-                mSelectedColor = img.pixelColor(pos);
-            } else {
-                mSelectedColor = QColor();
-            }
+            // invalid color outside of the image
+            mSelectedColor  = mImageLabel->pixelColor(pos);
+            mSelectedValues = mImageLabel->pixelValues(pos);
         }
 
         emit pixelValueChanged(pos, mSelectedColor);
     } else {
         if (mSelectedEditor && mSelectedEditor->isCreation()) {
             mSelectedEditor->select(mMousePos);
+            mEditorIndex.update(mSelectedEditor);
             update();
             return;
         }
 
-        auto pos = mMousePos;
+        // only editors near the mouse can be hit, the topmost first
+        syncTouched();
+        auto pos      = mMousePos;
+        auto previous = mSelectedEditor;
         mSelectedEditor.reset();
-        for (auto i = mEditors.size() - 1; i >= 0; i--) {
-            auto &editor = mEditors[ i ];
+        for (const auto &editor : mEditorIndex.query({pos}, mHitDistance / mWorldScale)) {
             if (editor->category()->visible() && editor->select(pos)) {
                 mSelectedEditor = editor;
 
@@ -104,6 +178,10 @@ void ImageViewer::mousePressEvent(QMouseEvent *event) {
                 pos.setX(std::numeric_limits<float>::max());
             }
         }
+
+        if (previous && previous != mSelectedEditor) {
+            previous->select(QPointF(std::numeric_limits<float>::max(), pos.y()));
+        }
     }
 
     update();
@@ -123,6 +201,8 @@ void ImageViewer::mouseReleaseEvent(QMouseEvent *event) {
         mSelectedEditor->modify(mMousePos);
     }
 
+    mDensity.update(*mSelectedEditor);
+    mEditorIndex.update(mSelectedEditor);
     update();
 }
 
@@ -133,19 +213,41 @@ void ImageViewer::mouseMoveEvent(QMouseEvent *event) {
     auto oldPos     = mMousePosPixels;
     mMousePosPixels = event->pos();
 
-    // highlight
+    // the info overlay follows the mouse, its width changes with the text
+    QRegion damage(0, 0, width(), mInfoRect.height());
+
+    // highlight, only editors near the old or new mouse position can change. the selected one
+    // follows the mouse while it is created
     if (event->buttons() == Qt::NoButton) {
-        foreach (auto editor, mEditors) {
+        syncTouched();
+        auto editors = mEditorIndex.query({oldMousePos, mMousePos}, mHitDistance / mWorldScale);
+        if (mSelectedEditor && !editors.contains(mSelectedEditor)) {
+            editors.append(mSelectedEditor);
+        }
+
+        for (const auto &editor : editors) {
             if (!editor->category()->visible()) {
                 continue;
             }
+
+            // highlighting only changes an editor under the old or new mouse position
+            const auto before = screenRect(*editor);
             editor->moving(mMousePos, oldMousePos);
+            const auto after = screenRect(*editor);
+            if (before != after || after.contains(oldPos) || after.contains(mMousePosPixels)) {
+                invalidateLayer(*editor, before);
+                invalidateLayer(*editor, after);
+                damage += before;
+                damage += after;
+            }
         }
     }
 
     if (mSelectedEditor && (event->buttons() & Qt::LeftButton)) {
+        damage += screenRect(*mSelectedEditor);
         mSelectedEditor->moving(mMousePos, oldMousePos);
-        update();
+        damage += screenRect(*mSelectedEditor);
+        update(damage);
         return;
     }
 
@@ -153,15 +255,19 @@ void ImageViewer::mouseMoveEvent(QMouseEvent *event) {
         auto delta          = oldPos - mMousePosPixels;
         mWorldOffset       -= QPointF(delta.x() / mWorldScale, delta.y() / mWorldScale);
         mFitToViewOnResize  = false;
+        update();
+        return;
     }
 
-    update();
+    update(damage);
 }
 
 void ImageViewer::wheelEvent(QWheelEvent *event) {
     if (mSelectedEditor && QApplication::keyboardModifiers() == Qt::NoModifier) {
         auto delta = event->angleDelta().y() / 128.;
         mSelectedEditor->rotate(delta);
+        mDensity.update(*mSelectedEditor);
+        mEditorIndex.update(mSelectedEditor);
         update();
         return;
     }
@@ -188,11 +294,18 @@ void ImageViewer::wheelEvent(QWheelEvent *event) {
 }
 
 void ImageViewer::keyPressEvent(QKeyEvent *event) {
+    if (event->key() == Qt::Key_Escape) {
+        cancelLoad();
+        return;
+    }
+
     if (event->key() == Qt::Key_Delete) {
         if (!mSelectedEditor) {
             return;
         }
 
+        mDensity.remove(*mSelectedEditor);
+        mEditorIndex.remove(*mSelectedEditor);
         mEditors.removeAll(mSelectedEditor);
         mSelectedEditor.reset();
     }
@@ -201,6 +314,10 @@ void ImageViewer::keyPressEvent(QKeyEvent *event) {
 }
 
 void ImageViewer::resizeEvent(QResizeEvent *event) {
+    if (mCanvas) {
+        mCanvas->resize(size());
+    }
+
     if (mFitToViewOnResize) {
         fitToView();
     }
@@ -243,16 +360,16 @@ void ImageViewer::zoomOut() {
 }
 
 void ImageViewer::fitToView() {
-    if (!mImageLabel || mImageLabel->image().isNull()) {
+    if (!mImageLabel || mImageLabel->isNull()) {
         resetWorldTransform();
     } else {
-        const auto &img    = mImageLabel->image();
-        auto        scaleX = double(width()) / img.width();
-        auto        scaleY = double(height()) / img.height();
+        const auto size   = mImageLabel->size();
+        auto       scaleX = double(width()) / size.width();
+        auto       scaleY = double(height()) / size.height();
 
         setWorldScale(std::min(scaleX, scaleY));
-        mWorldOffset = {(width() / mWorldScale - img.width()) / 2,
-                        (height() / mWorldScale - img.height()) / 2};
+        mWorldOffset = {(width() / mWorldScale - size.width()) / 2,
+                        (height() / mWorldScale - size.height()) / 2};
     }
 
     mFitToViewOnResize = true;
@@ -292,22 +409,233 @@ void ImageViewer::setMousePos(QMouseEvent *event) {
     mMousePos = getWorldTransform().inverted().map(QPointF(event->pos()));
 }
 
+QRect ImageViewer::screenRect(const Label &label) const {
+    const auto bounds = label.boundingRect();
+    if (bounds.isNull()) {
+        return rect();
+    }
+
+    // pens are lineWidth wide on screen, handles up to 1.5 times that
+    const int lineWidth = label.category() ? abs(label.category()->lineWidth()) : 1;
+    const int padding   = lineWidth * 3 + 12;
+    return getWorldTransform()
+        .mapRect(bounds)
+        .toAlignedRect()
+        .adjusted(-padding, -padding, padding, padding);
+}
+
+void ImageViewer::paintLayers(QPainter &painter, const PaintInfo &info) {
+    // categories in the order their first label was added. with background rendering the
+    // labels are composed by the scene renderer, editors are still drawn here
+    QVector<LabelCategory *>                 order;
+    QHash<LabelCategory *, QVector<Label *>> groups;
+    QHash<LabelCategory *, QVector<Label *>> sceneGroups;
+
+    const auto add = [ & ](Label *label, QHash<LabelCategory *, QVector<Label *>> &into) {
+        auto *category = label->category().data();
+        if (!groups.contains(category) && !sceneGroups.contains(category)) {
+            order.append(category);
+        }
+        into[ category ].append(label);
+    };
+
+    for (const auto &label : mLabels) {
+        add(label.data(), mBackgroundRendering ? sceneGroups : groups);
+    }
+    for (const auto &editor : mEditors) {
+        if (editor != mSelectedEditor) {
+            add(editor.data(), groups);
+        }
+    }
+
+    for (auto it = mLayers.begin(); it != mLayers.end();) {
+        if (groups.contains(it.key()) || sceneGroups.contains(it.key())) {
+            ++it;
+            continue;
+        }
+
+        disconnect(it.key(), nullptr, this, nullptr);
+        it = mLayers.erase(it);
+    }
+
+    // a layer per category even if it only has scene labels, its category is watched
+    for (auto *category : order) {
+        if (!mLayers.contains(category)) {
+            watchCategory(category);
+            mLayers.insert(category, {});
+        }
+    }
+
+    if (mBackgroundRendering) {
+        paintScene(painter, order, sceneGroups, info);
+    } else if (!mSceneRenderer.frame().image.isNull()) {
+        mSceneRenderer.clear();
+    }
+
+    const auto transform = getWorldTransform();
+    const auto bounds    = [ this ](const Label &label) { return screenRect(label); };
+    qint64     bytes     = mSceneRenderer.frame().image.sizeInBytes();
+    for (auto *category : order) {
+        auto &layer = mLayers[ category ];
+        if (category->visible() && groups.contains(category)) {
+            const bool redrawn = layer.paint(&painter, groups[ category ], info, transform, bounds);
+            mPaintStats.count(PaintStats::Layers, redrawn ? 0u : 1u, redrawn ? 1u : 0u);
+        }
+        bytes += layer.sizeInBytes();
+    }
+    mLayerMemory.setUsage(bytes);
+}
+
+void ImageViewer::paintScene(QPainter &painter, const QVector<LabelCategory *> &order,
+                             const QHash<LabelCategory *, QVector<Label *>> &groups,
+                             const PaintInfo &info) {
+    // the snapshot is taken again when a label, the label list or the zoom changed
+    quint64 revision = 0;
+    int     count    = 0;
+    for (const auto &group : groups) {
+        for (const auto *label : group) {
+            revision = std::max(revision, label->revision());
+        }
+        count += static_cast<int>(group.size());
+    }
+
+    if (mSceneDirty || revision != mSceneRevision || count != mSceneCount ||
+        !qFuzzyCompare(info.worldScale, mScene.worldScale)) {
+        mScene      = SceneRenderer::Scene();
+        mSceneLive  = {};
+        mSceneDirty = false;
+
+        mScene.worldScale = info.worldScale;
+        for (auto *category : order) {
+            if (!category->visible() || !groups.contains(category)) {
+                continue;
+            }
+
+            SceneRenderer::Layer layer;
+            layer.color         = category->color();
+            layer.lineWidth     = category->lineWidth();
+            layer.batch.dotSize = mMinLabelPixels;
+            for (auto *label : groups[ category ]) {
+                const auto box = label->boundingRect();
+                if (!box.isNull() &&
+                    std::max(box.width(), box.height()) * info.worldScale < mMinLabelPixels) {
+                    layer.batch.dots.append(box.center());
+                } else if (!label->batch(layer.batch, info)) {
+                    mSceneLive.append(label);
+                }
+            }
+            mScene.layers.append(layer);
+        }
+
+        mSceneRevision  = revision;
+        mSceneCount     = count;
+        mSceneRequested = false;
+    }
+
+    // a new frame when the scene or the view changed since the last request
+    const auto transform = getWorldTransform();
+    if (!mSceneRequested || mSceneTransform != transform || mSceneSize != size()) {
+        mSceneRenderer.render(mScene, transform, size(), devicePixelRatioF());
+        mSceneRequested = true;
+        mSceneTransform = transform;
+        mSceneSize      = size();
+    }
+
+    // the newest frame follows the view until the one for it is ready
+    const auto &frame = mSceneRenderer.frame();
+    if (!frame.image.isNull() && frame.transform.isInvertible()) {
+        painter.save();
+        painter.setTransform(frame.transform.inverted() * transform);
+        painter.drawImage(QPointF(0, 0), frame.image);
+        painter.restore();
+    }
+
+    // labels that can not be batched are drawn here
+    for (auto *label : mSceneLive) {
+        label->onPaint(info);
+    }
+}
+
+void ImageViewer::invalidateLayer(const Label &label, const QRect &rect) {
+    auto it = mLayers.find(label.category().data());
+    if (it != mLayers.end()) {
+        it->invalidate(rect);
+    }
+}
+
+void ImageViewer::syncTouched() {
+    const auto newest = Label::newestRevision();
+    if (newest == mSyncedRevision) {
+        return;
+    }
+
+    for (const auto &label : mLabels) {
+        if (label->revision() > mSyncedRevision) {
+            mDensity.update(*label);
+        }
+    }
+    for (const auto &editor : mEditors) {
+        if (editor->revision() > mSyncedRevision) {
+            mDensity.update(*editor);
+            mEditorIndex.update(editor);
+        }
+    }
+    mSyncedRevision = newest;
+}
+
+void ImageViewer::watchCategory(LabelCategory *category) {
+    const auto invalidate = [ this, category ]() {
+        auto it = mLayers.find(category);
+        if (it != mLayers.end()) {
+            it->invalidate();
+        }
+        mSceneDirty = true;
+        update();
+    };
+
+    connect(category, &LabelCategory::colorChanged, this, invalidate);
+    connect(category, &LabelCategory::lineWidthChanged, this, invalidate);
+    connect(category, &LabelCategory::visiableChanged, this, invalidate);
+    connect(category, &QObject::destroyed, this, [ this, category ]() {
+        mLayers.remove(category);
+        mSceneDirty = true;
+    });
+}
+
 void ImageViewer::displayInfo(QPainter &painter) {
     painter.save();
 
-    QImage      empty;
-    const auto &img =
-        (mImageLabel && !mImageLabel->image().isNull()) ? mImageLabel->image() : empty;
+    const auto size   = mImageLabel ? mImageLabel->size() : QSize();
+    const auto format = mImageLabel ? mImageLabel->format() : QImage::Format_Invalid;
 
-    auto str1 = (img.isNull() ? "" : QString("%1x%2 ").arg(img.width()).arg(img.height())) +
+    auto str1 = (size.isEmpty() ? "" : QString("%1x%2 ").arg(size.width()).arg(size.height())) +
                 QString::number(mWorldScale * 100.f, 'f', 2) + "%";
+    if (mStreaming) {
+        const auto stats = mFrames.stats();
+        str1 += QString(" %1/%2 frames").arg(stats.presented).arg(stats.received);
+    }
     auto str2 = QString("%1,%2").arg(mMousePos.x()).arg(mMousePos.y());
-    auto str3 = img.format() != QImage::Format_Grayscale8
-                    ? QString("R:%1,G:%2,B:%3")
-                          .arg(mSelectedColor.red())
-                          .arg(mSelectedColor.green())
-                          .arg(mSelectedColor.blue())
-                    : QString("L:%1").arg(mSelectedColor.lightness());
+    QString str3;
+    if (mSelectedValues.size() == 1) {
+        str3 = QString("L:%1").arg(mSelectedValues[ 0 ]);
+    } else if (mSelectedValues.size() == 3) {
+        str3 = QString("R:%1,G:%2,B:%3")
+                   .arg(mSelectedValues[ 0 ])
+                   .arg(mSelectedValues[ 1 ])
+                   .arg(mSelectedValues[ 2 ]);
+    } else {
+        str3 = format != QImage::Format_Grayscale8
+                   ? QString("R:%1,G:%2,B:%3")
+                         .arg(mSelectedColor.red())
+                         .arg(mSelectedColor.green())
+                         .arg(mSelectedColor.blue())
+                   : QString("L:%1").arg(mSelectedColor.lightness());
+    }
+
+    if (mImageLabel && mImageLabel->isHighDepth()) {
+        const auto window = mImageLabel->window();
+        str3 += QString(" W:%1-%2").arg(window.first).arg(window.second);
+    }
 
     QFontMetrics fm(painter.font());
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
@@ -330,7 +658,8 @@ void ImageViewer::displayInfo(QPainter &painter) {
 
     painter.setPen(QPen(Qt::transparent));
     painter.setBrush(QColor(35, 35, 35, 100));
-    painter.drawRect(QRect(0, 0, width + 5, height + 5));
+    mInfoRect = QRect(0, 0, width + 5, height + 5);
+    painter.drawRect(mInfoRect);
     painter.setPen(QPen(QColor(150, 250, 150)));
     painter.drawText(2, height1, str1);
     painter.drawText(2, height1 * 2, str2);
@@ -338,12 +667,72 @@ void ImageViewer::displayInfo(QPainter &painter) {
         painter.drawText(2, height1 * 3, str3);
     }
 
+    if (mShowPaintStats) {
+        mInfoRect |= displayPaintStats(painter, mInfoRect.bottom() + 1);
+    }
+
     painter.restore();
 }
 
+QRect ImageViewer::displayPaintStats(QPainter &painter, int top) {
+    const auto percent = [ this ](PaintStats::Cache cache) {
+        const auto rate = mPaintStats.hitRate(cache);
+        return rate < 0 ? QString("-") : QString("%1%").arg(qRound(rate * 100.));
+    };
+
+    QStringList lines;
+    lines << QString("%1 ms %2 fps")
+                 .arg(mPaintStats.frameMs(), 0, 'f', 2)
+                 .arg(mPaintStats.fps(), 0, 'f', 1);
+    for (int i = 0; i < PaintStats::StageCount; i++) {
+        const auto stage = static_cast<PaintStats::Stage>(i);
+        lines << QString("%1 %2 ms")
+                     .arg(PaintStats::name(stage))
+                     .arg(mPaintStats.stageMs(stage), 0, 'f', 2);
+    }
+    lines << QString("%1 labels %2 editors").arg(mLabels.size()).arg(mEditors.size());
+    lines << QString("hits %1 %2 %3 %4")
+                 .arg(PaintStats::name(PaintStats::Layers))
+                 .arg(percent(PaintStats::Layers))
+                 .arg(PaintStats::name(PaintStats::Tiles))
+                 .arg(percent(PaintStats::Tiles));
+
+    QFontMetrics fm(painter.font());
+    int          width = 0;
+    for (const auto &line : lines) {
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+        width = std::max(width, fm.boundingRect(line).width());
+#else
+        width = std::max(width, fm.width(line));
+#endif
+    }
+
+    const QRect rect(0, top, width + 5, fm.height() * static_cast<int>(lines.size()) + 5);
+    painter.setPen(QPen(Qt::transparent));
+    painter.setBrush(QColor(35, 35, 35, 100));
+    painter.drawRect(rect);
+    painter.setPen(QPen(QColor(250, 220, 120)));
+    for (int i = 0; i < lines.size(); i++) {
+        painter.drawText(2, top + fm.height() * (i + 1), lines[ i ]);
+    }
+
+    return rect;
+}
+
 void ImageViewer::loadImage(const QString &filepath) {
-    const QImage img(filepath);
-    setImage(img);
+    // huge images are decoded on demand, tile by tile
+    auto source = TileSource::open(filepath, mTiledImagePixels);
+    if (source) {
+        mLoader->cancel();
+        setTileSource(source);
+        return;
+    }
+
+    mLoader->load(filepath);
+}
+
+void ImageViewer::cancelLoad() {
+    mLoader->cancel();
 }
 
 void ImageViewer::setImage(const QImage &img_) {
@@ -351,8 +740,11 @@ void ImageViewer::setImage(const QImage &img_) {
         return;
     }
 
-    mImageLabel.reset(new ImageLabel);
-    mImageLabel->setImage(img_);
+    mStreaming = false;
+
+    QSharedPointer<ImageLabel> imageLabel(new ImageLabel);
+    imageLabel->setImage(img_);
+    setImageLabel(imageLabel);
 
     emit imageSizeChanged(img_.size());
 
@@ -363,6 +755,55 @@ void ImageViewer::setImage(const QImage &img_) {
     update();
 }
 
+void ImageViewer::setTileSource(const QSharedPointer<TileSource> &source) {
+    if (!source) {
+        return;
+    }
+
+    mStreaming = false;
+
+    QSharedPointer<ImageLabel> imageLabel(new ImageLabel);
+    imageLabel->setTileSource(source);
+    setImageLabel(imageLabel);
+
+    emit imageSizeChanged(source->size());
+
+    if (mFitToViewOnLoad) {
+        fitToView();
+    }
+
+    update();
+}
+
+void ImageViewer::presentFrame(QImage frame) {
+    if (frame.isNull() || !mFrames.push(std::move(frame))) {
+        return;
+    }
+
+    // one queued repaint at a time, frames pushed meanwhile replace the pending one
+    QMetaObject::invokeMethod(this, QOverload<>::of(&ImageViewer::update), Qt::QueuedConnection);
+}
+
+void ImageViewer::resetFrameStats() {
+    mFrames.reset();
+}
+
+FrameQueue::Stats ImageViewer::frameStats() const {
+    return mFrames.stats();
+}
+
+void ImageViewer::showFrame(const QImage &frame) {
+    const bool reuse = mStreaming && mImageLabel && !mImageLabel->tileSource() &&
+                       mImageLabel->size() == frame.size();
+    if (!reuse) {
+        setImage(frame);
+        mStreaming = true;
+        return;
+    }
+
+    mImageLabel->setFrame(frame);
+}
+
 QImage ImageViewer::image() const {
     if (!mImageLabel || mImageLabel->image().isNull()) {
         return {};
@@ -376,30 +817,12 @@ QImage ImageViewer::rendering() const {
         return {};
     }
 
-    auto &img = mImageLabel->image();
-
-    QPixmap  target = QPixmap::fromImage(img, Qt::ColorOnly);
-    QPainter painter(&target);
-
-    PaintInfo info;
-    info.painter    = &painter;
-    info.worldScale = 1.;
-    info.size       = img.size();
-    info.offset     = {0, 0};
-    foreach (auto &label, mLabels) {
-        if (!label->category()->visible()) {
-            continue;
-        }
-        label->onPaint(info);
-    }
-    foreach (auto &editor, mEditors) {
-        if (!editor->category()->visible()) {
-            continue;
-        }
-        editor->onPaint(info);
+    auto labels = mLabels;
+    for (const auto &editor : mEditors) {
+        labels.append(editor);
     }
 
-    return target.toImage();
+    return renderLabels(mImageLabel->displayImage(), labels);
 }
 
 void ImageViewer::addLabel(const QSharedPointer<Label> &label) {
@@ -409,35 +832,70 @@ void ImageViewer::addLabel(const QSharedPointer<Label> &label) {
 
     auto imageLabel = label.dynamicCast<ImageLabel>();
     if (imageLabel) {
-        mImageLabel = imageLabel;
+        setImageLabel(imageLabel);
     } else {
         mLabels.append(label);
+        mDensity.add(*label);
     }
 
     update();
 }
 
 void ImageViewer::removeLabel(const QSharedPointer<Label> &label) {
-    mLabels.removeAll(label);
+    if (mLabels.removeAll(label) > 0) {
+        mDensity.remove(*label);
+        mSceneDirty = true;
+    }
     if (mImageLabel == label) {
-        mImageLabel.reset();
+        setImageLabel({});
     }
 
     update();
 }
 
 void ImageViewer::clearLabel() {
+    for (const auto &label : mLabels) {
+        mDensity.remove(*label);
+    }
     mLabels.clear();
-    mImageLabel.reset();
+    mSceneDirty = true;
+    mSceneRenderer.clear();
+    setImageLabel({});
     update();
 }
 
+void ImageViewer::setImageLabel(const QSharedPointer<ImageLabel> &label) {
+    if (mImageLabel) {
+        disconnect(mImageLabel->pyramid(), nullptr, this, nullptr);
+        disconnect(mImageLabel->tileCache(), nullptr, this, nullptr);
+        disconnect(mImageLabel->resampler(), nullptr, this, nullptr);
+    }
+
+    mImageLabel = label;
+    mDensity.setImageSize(mImageLabel ? mImageLabel->size() : QSize());
+    if (mImageLabel) {
+        // about 128 cells on the long side
+        const auto size = mImageLabel->size();
+        mEditorIndex.setCellSize(std::max(16., std::max(size.width(), size.height()) / 128.));
+    }
+    if (mImageLabel) {
+        connect(mImageLabel->pyramid(), &ImagePyramid::levelsReady, this,
+                QOverload<>::of(&ImageViewer::update));
+        connect(mImageLabel->tileCache(), &TileCache::tileReady, this,
+                QOverload<>::of(&ImageViewer::update));
+        connect(mImageLabel->resampler(), &ViewResampler::ready, this,
+                QOverload<>::of(&ImageViewer::update));
+    }
+}
+
 void ImageViewer::addEditor(const QSharedPointer<LabelEditor> &editor) {
     if (!editor) {
         return;
     }
 
     mEditors.append(editor);
+    mDensity.add(*editor);
+    mEditorIndex.insert(editor);
     if (editor->isCreation()) {
         mSelectedEditor = editor;
     }
@@ -445,12 +903,19 @@ void ImageViewer::addEditor(const QSharedPointer<LabelEditor> &editor) {
 }
 
 void ImageViewer::removeEditor(const QSharedPointer<LabelEditor> &editor) {
-    mEditors.removeAll(editor);
+    if (mEditors.removeAll(editor) > 0) {
+        mDensity.remove(*editor);
+        mEditorIndex.remove(*editor);
+    }
     mSelectedEditor.reset();
     update();
 }
 
 void ImageViewer::clearEditor() {
+    for (const auto &editor : mEditors) {
+        mDensity.remove(*editor);
+    }
+    mEditorIndex.clear();
     mEditors.clear();
     mSelectedEditor.reset();
     update();
@@ -459,3 +924,59 @@ void ImageViewer::clearEditor() {
 void ImageViewer::setInSelect(bool pixelSelect) {
     mInPixelSelect = pixelSelect;
 }
+
+bool ImageViewer::setOpenGL(bool enable) {
+#ifdef VIEWER_OPENGL
+    if (enable == (mCanvas != nullptr)) {
+        return true;
+    }
+
+    if (!enable || !GLCanvas::isSupported()) {
+        delete mCanvas;
+        mCanvas = nullptr;
+        update();
+        return !enable;
+    }
+
+    mCanvas = new GLCanvas([ this ](QPainter &painter) { paint(painter, QRegion(rect())); }, this);
+    mCanvas->resize(size());
+    mCanvas->show();
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+void ImageViewer::setBackgroundRendering(bool enable) {
+    mBackgroundRendering = enable;
+    mSceneDirty          = true;
+    update();
+}
+
+void ImageViewer::setShowPaintStats(bool show) {
+    mShowPaintStats = show;
+    update();
+}
+
+void ImageViewer::setDensityScale(double scale) {
+    mDensityScale = scale;
+    update();
+}
+
+void ImageViewer::setDisplayWindow(double low, double high) {
+    if (!mImageLabel || high <= low) {
+        return;
+    }
+
+    mImageLabel->setWindow(low, high);
+    update();
+}
+
+void ImageViewer::resetDisplayWindow() {
+    if (!mImageLabel) {
+        return;
+    }
+
+    mImageLabel->resetWindow();
+    update();
+}
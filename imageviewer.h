@@ -2,12 +2,23 @@
 #define IMAGEVIEWER_H
 
 #include <QImage>
+#include <QTimer>
 #include <QWidget>
 
+#include "editorindex.h"
+#include "image/framequeue.h"
+#include "image/memorybudget.h"
 #include "label.h"
+#include "labeldensity.h"
 #include "labeleditor.h"
+#include "labellayer.h"
+#include "paintstats.h"
+#include "scenerenderer.h"
 
+class GLCanvas;
 class ImageLabel;
+class ImageLoader;
+class TileSource;
 
 class ImageViewer : public QWidget {
     Q_OBJECT
@@ -32,11 +43,31 @@ public slots:
     void resetToOriginalSize();
 
     void   loadImage(const QString &filepath);
+    void   cancelLoad();
     void   setImage(const QImage &img);
+    void   setTileSource(const QSharedPointer<TileSource> &source);
+    // live frames from any thread, only the newest one is painted. view, labels and editors
+    // are kept, the view is only fitted again when the frame size changes
+    void              presentFrame(QImage frame);
+    void              resetFrameStats();
+    FrameQueue::Stats frameStats() const;
     QImage image() const;
     QImage rendering() const;
 
     void setInSelect(bool pixelSelect);
+    // paint through an OpenGL canvas instead of the raster engine, VIEWER_OPENGL=1 enables it
+    // at start. false if OpenGL is not available, the widget keeps painting itself then
+    bool setOpenGL(bool enable);
+    // below `scale` labels are drawn as a density map per category, 0 never
+    void setDensityScale(double scale);
+    // labels composed on a worker thread, editors stay drawn on the GUI thread
+    void setBackgroundRendering(bool enable);
+    // timings of the paint stages, rate, counts and cache hits under the info text
+    void setShowPaintStats(bool show);
+
+    // display window of 16bit and float images, reset follows the image range
+    void setDisplayWindow(double low, double high);
+    void resetDisplayWindow();
 
     void addLabel(const QSharedPointer<Label> &label);
     void removeLabel(const QSharedPointer<Label> &label);
@@ -50,6 +81,9 @@ signals:
     void scaleFactorChanged(double factor);
     void imageSizeChanged(const QSize &size);
     void pixelValueChanged(const QPoint &pos, const QColor &value);
+    void loadProgress(int percent);
+    void loadFinished(const QString &filepath, bool success);
+    void loadCanceled(const QString &filepath);
 
 private:
     void       resetWorldTransform();
@@ -61,15 +95,55 @@ private:
     QPointF getMousePos();
     void    setMousePos(QMouseEvent *);
 
+    void paint(QPainter &painter, const QRegion &region);
     void displayInfo(QPainter &painter);
+    QRect displayPaintStats(QPainter &painter, int top);
+    // widget area painted by a label, padded for lines and handles, all if unknown
+    QRect screenRect(const Label &label) const;
+
+    // labels and editors are drawn from cached layers, one per category, except the selected
+    // editor which is drawn live
+    void paintLayers(QPainter &painter, const PaintInfo &info);
+    void paintScene(QPainter &painter, const QVector<LabelCategory *> &order,
+                    const QHash<LabelCategory *, QVector<Label *>> &groups, const PaintInfo &info);
+    void invalidateLayer(const Label &label, const QRect &rect);
+    void watchCategory(LabelCategory *category);
+    // labels and editors whose geometry was set since the last call are binned again in the
+    // density grid and the editor index
+    void syncTouched();
+
+    void setImageLabel(const QSharedPointer<ImageLabel> &label);
+    void showFrame(const QImage &frame);
 
 private:
     // file model
+    ImageLoader                *mLoader = nullptr;
     QSharedPointer<ImageLabel>  mImageLabel;
     QSharedPointer<LabelEditor> mSelectedEditor;
 
     QList<QSharedPointer<LabelEditor>> mEditors;
     QList<QSharedPointer<Label>>       mLabels;
+    EditorIndex                        mEditorIndex;
+    const double                       mHitDistance    = 8.; // screen pixels around an editor
+    quint64                            mSyncedRevision = 0;  // newest label revision binned
+
+    QHash<LabelCategory *, LabelLayer> mLayers;
+    BudgetClient                       mLayerMemory;
+    LabelDensity                       mDensity;
+    double                             mDensityScale = 0.1;
+
+    // labels composed in background, a snapshot of them is handed to the renderer
+    SceneRenderer        mSceneRenderer;
+    SceneRenderer::Scene mScene;
+    QVector<Label *>     mSceneLive; // not batchable, drawn on the GUI thread
+    bool                 mBackgroundRendering = true;
+    bool                 mSceneDirty          = true;
+    quint64              mSceneRevision       = 0;
+    int                  mSceneCount          = 0;
+    bool                 mSceneRequested      = false;
+    QTransform           mSceneTransform;
+    QSize                mSceneSize;
+    const double         mMinLabelPixels = 2.; // smaller labels are a dot, as in the layers
 
     // scale and transform of the objects on the desktop
     double       mWorldScale        = 1;
@@ -80,18 +154,35 @@ private:
     const double mMaxScale          = 100.;
     const double mScaleStep         = 0.1;
 
+    QTimer     mIdleTimer;
+    QTransform mIdleView;        // image transform of the last paint
+    const int  mIdleDelay = 150; // ms without a view change before resampling sharply
+
     bool mFitToViewOnLoad   = true; // fit loaded image to view when it is loaded by SetBackground
     bool mFitToViewOnResize = true; // fit loaded image to view when widow is resized
 
+    const qint64 mTiledImagePixels = 256LL * 1024 * 1024; // decode larger images tile by tile
+
     QPointF mMousePos;       // mouse position in background picture coordinates
     QPoint  mMousePosPixels; // mouse position in window coordinate system
     double  mMouseAngle = 0;
 
     // current mode
-    bool   mInPixelSelect = false;
-    QColor mSelectedColor;
+    bool            mInPixelSelect = false;
+    QColor          mSelectedColor;
+    QVector<double> mSelectedValues; // native samples, not windowed
 
     QImage mBackground;
+    QRect  mInfoRect; // info overlay of the last paint
+
+    PaintStats mPaintStats;
+    bool       mShowPaintStats = false;
+
+    GLCanvas *mCanvas = nullptr;
+
+    // live stream
+    FrameQueue mFrames;
+    bool       mStreaming = false;
 };
 
 #endif // IMAGEVIEWER_H
@@ -1,21 +1,53 @@
 #include "label.h"
 
+#include <atomic>
+
+namespace {
+// revisions of all labels are ordered, a cache only keeps the newest one it has drawn
+std::atomic<quint64> lastRevision{0};
+} // namespace
+
 Label::Label() {
     mCategory.reset(new LabelCategory);
+    touch();
 }
 
 void Label::setCategory(QSharedPointer<LabelCategory> category) {
     mCategory = std::move(category);
+    touch();
 }
 
 QSharedPointer<LabelCategory> Label::category() const {
     return mCategory;
 }
 
+void Label::touch() {
+    mRevision = ++lastRevision;
+}
+
+quint64 Label::revision() const {
+    return mRevision;
+}
+
+quint64 Label::newestRevision() {
+    return lastRevision;
+}
+
+QRectF Label::boundingRect() const {
+    return {};
+}
+
+bool Label::batch(PaintBatch &batch, const PaintInfo &info) {
+    Q_UNUSED(batch)
+    Q_UNUSED(info)
+    return false;
+}
+
 QStringList Label::serialize() const {
     return {};
 }
 
-void Label::deserialize(const QStringList &source) {
+bool Label::deserialize(const QStringList &source) {
     Q_UNUSED(source)
+    return false;
 }
@@ -3,6 +3,8 @@
 
 #include "labelcategory.h"
 
+struct PaintBatch;
+
 class Label {
 public:
     Label();
@@ -12,11 +14,25 @@ public:
     QSharedPointer<LabelCategory> category() const;
 
     virtual void        onPaint(const PaintInfo &info) = 0;
+    // area painted in image coordinates, without pen width, handles and other parts of
+    // constant screen size. null if unknown
+    virtual QRectF      boundingRect() const;
+    // adds the label to `batch` instead of painting it, false if it has to be painted alone
+    virtual bool        batch(PaintBatch &batch, const PaintInfo &info);
     virtual QStringList serialize() const;
-    virtual void        deserialize(const QStringList &source);
+    // false if `source` is not a valid label, which is then left unchanged
+    virtual bool        deserialize(const QStringList &source);
+
+    // marks the label as changed, cached drawings of it are redrawn. geometry setters and
+    // deserialize() call it, of editors too
+    void    touch();
+    quint64 revision() const;
+    // of the label touched last, a caller compares it to tell if any label changed
+    static quint64 newestRevision();
 
 private:
     QSharedPointer<LabelCategory> mCategory;
+    quint64                       mRevision = 0;
 };
 
 #endif // LABEL_H
@@ -1,4 +1,5 @@
 #include "circlelabel.h"
+#include "paintbatch.h"
 #include "utils.h"
 
 CircleLabel::CircleLabel() = default;
@@ -14,6 +15,17 @@ void CircleLabel::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF CircleLabel::boundingRect() const {
+    return {mCenter.x() - mRadius, mCenter.y() - mRadius, mRadius * 2, mRadius * 2};
+}
+
+bool CircleLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    Q_UNUSED(info)
+
+    batch.outlines.addEllipse(mCenter, mRadius, mRadius);
+    return true;
+}
+
 double CircleLabel::radius() const {
     return mRadius;
 }
@@ -25,6 +37,22 @@ QPointF CircleLabel::center() const {
 void CircleLabel::setCircle(const QPointF &center, double radius) {
     mRadius = radius;
     mCenter = center;
+    touch();
+}
+
+// center x, center y, radius
+QStringList CircleLabel::serialize() const {
+    return toStrings({mCenter.x(), mCenter.y(), mRadius});
+}
+
+bool CircleLabel::deserialize(const QStringList &source) {
+    auto values = toNumbers(source);
+    if (values.size() != 3) {
+        return false;
+    }
+
+    setCircle({values[ 0 ], values[ 1 ]}, values[ 2 ]);
+    return true;
 }
 
 QPen CircleLabel::getOutlinePen(const PaintInfo &info) const {
@@ -7,7 +7,11 @@ class CircleLabel : public Label {
 public:
     CircleLabel();
 
-    void onPaint(const PaintInfo &info) override;
+    void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
+    bool        batch(PaintBatch &batch, const PaintInfo &info) override;
+    QStringList serialize() const override;
+    bool        deserialize(const QStringList &source) override;
 
     double  radius() const;
     QPointF center() const;
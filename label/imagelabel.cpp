@@ -1,15 +1,451 @@
 #include "imagelabel.h"
+#include "image/displayformat.h"
+#include "image/windowlevel.h"
 
-ImageLabel::ImageLabel() = default;
+#include <QPaintEngine>
+
+#include <algorithm>
+#include <cmath>
+
+ImageLabel::ImageLabel()
+    : mPyramid(new ImagePyramid)
+    , mTiles(new TileCache)
+    , mResampler(new ViewResampler)
+    , mImageMemory(MemoryBudget::DecodedImage)
+    , mDisplayMemory(MemoryBudget::DisplayCache, 3, [ this ](qint64) { evictDisplay(); }) {}
 
 void ImageLabel::onPaint(const PaintInfo &info) {
-    info.painter->drawImage(0, 0, mImage);
+    if (mTiles->source()) {
+        paintTiles(info);
+        return;
+    }
+
+    // only the part in the viewport is drawn, one more pixel around for the half pixel offset
+    const auto source =
+        visibleRect(info).adjusted(-1, -1, 1, 1).toAlignedRect().intersected(mImage.rect());
+    if (source.isEmpty()) {
+        return;
+    }
+
+    // deep zoom: pixel exact blocks with a grid and the values instead of a resampled image
+    if (info.worldScale >= mPixelGridScale) {
+        if (!mDisplayValid.isEmpty()) {
+            updateDisplay(source);
+        }
+
+        const auto &pixels = mDisplay.isNull() ? mImage : mDisplay;
+        if (isDisplayFormat(pixels.format())) {
+            mPixelGrid.paint(info.painter, pixels, source,
+                             [ this ](const QPoint &pos) { return ::pixelValues(mImage, pos); });
+            return;
+        }
+    }
+
+    // zoomed out and idle: the view area averaged at its exact scale, made in background
+    if (info.worldScale < 1.) {
+        const auto transform = info.painter->worldTransform();
+        const auto sharp     = mResampler->result(transform, source);
+        if (!sharp.image.isNull()) {
+            info.painter->save();
+            info.painter->resetTransform();
+            info.painter->drawImage(sharp.target, sharp.image);
+            info.painter->restore();
+            return;
+        }
+
+        // the whole view, partial repaints only cover a part of it
+        mSharpTransform = transform;
+        mSharpRatio     = info.painter->device()->devicePixelRatioF();
+        mSharpSource    = transform.inverted()
+                           .mapRect(QRectF(info.painter->viewport()))
+                           .adjusted(-1, -1, 1, 1)
+                           .toAlignedRect()
+                           .intersected(mImage.rect());
+    }
+
+    // zoomed out: draw the coarsest mip level that still covers the screen resolution
+    auto level = mPyramid->levelForScale(info.worldScale);
+    if (level.isNull() || level.width() >= mImage.width()) {
+        if (!mDisplayValid.isEmpty()) {
+            updateDisplay(source);
+        }
+
+        const auto &pixels = mDisplay.isNull() ? mImage : mDisplay;
+        if (isDisplayFormat(pixels.format()) && info.painter->paintEngine() &&
+            info.painter->paintEngine()->type() == QPaintEngine::OpenGL2) {
+            paintTextureTiles(info, pixels, source);
+        } else {
+            info.painter->drawImage(source.topLeft(), pixels, source);
+        }
+        return;
+    }
+
+    // the level is stretched over the whole image, odd sizes included
+    const double sx          = double(level.width()) / mImage.width();
+    const double sy          = double(level.height()) / mImage.height();
+    const auto   levelSource = QRectF(source.x() * sx, source.y() * sy, source.width() * sx,
+                                      source.height() * sy)
+                                 .toAlignedRect()
+                                 .intersected(level.rect());
+    const QRectF target(levelSource.x() / sx, levelSource.y() / sy, levelSource.width() / sx,
+                        levelSource.height() / sy);
+    info.painter->drawImage(target, level, levelSource);
 }
 
 void ImageLabel::setImage(const QImage &image) {
+    mTiles->setSource({});
     mImage = image;
+
+    const auto range = sampleRange(mImage);
+    mWindowLow       = range.first;
+    mWindowHigh      = range.second;
+    resetDisplay();
+    buildPyramid();
+    updateUsage();
+}
+
+void ImageLabel::setFrame(const QImage &frame) {
+    mTiles->setSource({});
+
+    const bool sameFormat = frame.format() == mImage.format();
+    mImage                = frame;
+    if (!sameFormat) {
+        const auto range = sampleRange(mImage);
+        mWindowLow       = range.first;
+        mWindowHigh      = range.second;
+    }
+
+    resetDisplay();
+    mPyramid->clear();
+    updateUsage();
 }
 
 const QImage &ImageLabel::image() const {
     return mImage;
 }
+
+QImage ImageLabel::displayImage() const {
+    if (::isHighDepth(mImage.format())) {
+        return applyWindow(mImage, mWindowLow, mWindowHigh);
+    }
+
+    // the display copy only holds the tiles that were looked at
+    return toDisplayFormat(mImage);
+}
+
+void ImageLabel::setTileSource(const QSharedPointer<TileSource> &source) {
+    mImage = QImage();
+    resetDisplay();
+    buildPyramid();
+    updateUsage();
+    mTiles->setSource(source);
+}
+
+QSharedPointer<TileSource> ImageLabel::tileSource() const {
+    return mTiles->source();
+}
+
+QSize ImageLabel::size() const {
+    return mTiles->source() ? mTiles->source()->size() : mImage.size();
+}
+
+QImage::Format ImageLabel::format() const {
+    return mTiles->source() ? mTiles->source()->format() : mImage.format();
+}
+
+bool ImageLabel::isNull() const {
+    return size().isEmpty();
+}
+
+QColor ImageLabel::pixelColor(const QPoint &pos) const {
+    if (!QRect({0, 0}, size()).contains(pos)) {
+        return {};
+    }
+
+    if (!mTiles->source()) {
+        return mImage.pixelColor(pos);
+    }
+
+    // full resolution pixel, the cached tile may be a coarse level
+    auto pixel = mTiles->source()->read(QRect(pos, QSize(1, 1)), {1, 1});
+    return pixel.isNull() ? QColor() : pixel.pixelColor(0, 0);
+}
+
+QVector<double> ImageLabel::pixelValues(const QPoint &pos) const {
+    if (!QRect({0, 0}, size()).contains(pos)) {
+        return {};
+    }
+
+    if (!mTiles->source()) {
+        return ::pixelValues(mImage, pos);
+    }
+
+    auto pixel = mTiles->source()->read(QRect(pos, QSize(1, 1)), {1, 1});
+    return ::pixelValues(pixel, {0, 0});
+}
+
+bool ImageLabel::isHighDepth() const {
+    return ::isHighDepth(format());
+}
+
+void ImageLabel::setWindow(double low, double high) {
+    if (mTiles->source()) {
+        mTiles->setWindow(low, high);
+        return;
+    }
+
+    mWindowLow  = low;
+    mWindowHigh = high;
+    mResampler->clear();
+    if (!mDisplayValid.isEmpty() && ::isHighDepth(mImage.format())) {
+        mDisplayValid.fill(false);
+        buildPyramid();
+    }
+}
+
+void ImageLabel::resetWindow() {
+    if (mTiles->source()) {
+        mTiles->resetWindow();
+        return;
+    }
+
+    const auto range = sampleRange(mImage);
+    setWindow(range.first, range.second);
+}
+
+QPair<double, double> ImageLabel::window() const {
+    return mTiles->source() ? mTiles->window() : qMakePair(mWindowLow, mWindowHigh);
+}
+
+ImagePyramid *ImageLabel::pyramid() const {
+    return mPyramid.data();
+}
+
+TileCache *ImageLabel::tileCache() const {
+    return mTiles.data();
+}
+
+ViewResampler *ImageLabel::resampler() const {
+    return mResampler.data();
+}
+
+void ImageLabel::sharpen() {
+    if (mTiles->source() || mSharpSource.isEmpty() || mSharpTransform.m11() >= 1. ||
+        mSharpTransform.type() > QTransform::TxScale ||
+        !mResampler->result(mSharpTransform, mSharpSource).image.isNull() ||
+        mResampler->isPending(mSharpTransform, mSharpSource)) {
+        return;
+    }
+
+    // a level of about twice the view resolution, averaged down to it
+    auto image = mPyramid->levelForScale(mSharpTransform.m11() * 2.);
+    if (image.isNull() || image.width() >= mImage.width()) {
+        if (!mDisplayValid.isEmpty()) {
+            updateDisplay(mSharpSource);
+        }
+        image = mDisplay.isNull() ? mImage : mDisplay;
+    }
+
+    const double sx   = double(image.width()) / mImage.width();
+    const double sy   = double(image.height()) / mImage.height();
+    const auto   rect = QRectF(mSharpSource.x() * sx, mSharpSource.y() * sy,
+                               mSharpSource.width() * sx, mSharpSource.height() * sy)
+                          .toAlignedRect()
+                          .intersected(image.rect());
+    const QRectF area(rect.x() / sx, rect.y() / sy, rect.width() / sx, rect.height() / sy);
+    mResampler->request(image, rect, mSharpTransform.mapRect(area), mSharpRatio, mSharpTransform,
+                        mSharpSource);
+}
+
+void ImageLabel::paintTiles(const PaintInfo &info) {
+    const auto visible = visibleRect(info).intersected(QRectF({0, 0}, size()));
+    if (visible.isEmpty()) {
+        return;
+    }
+
+    mTiles->beginFrame();
+
+    // the coarsest level is a single small tile, keep it as placeholder while decoding
+    mTiles->tile(mTiles->levelCount() - 1, 0, 0);
+
+    const int level  = mTiles->levelForScale(info.worldScale);
+    const int span   = mTiles->tileSize() << level;
+    const int left   = static_cast<int>(visible.left()) / span;
+    const int top    = static_cast<int>(visible.top()) / span;
+    const int right  = static_cast<int>(std::ceil(visible.right())) / span;
+    const int bottom = static_cast<int>(std::ceil(visible.bottom())) / span;
+    for (int row = top; row <= bottom; row++) {
+        for (int column = left; column <= right; column++) {
+            const auto rect = mTiles->tileRect(level, column, row);
+            if (rect.isEmpty()) {
+                continue;
+            }
+
+            auto tile = mTiles->tile(level, column, row);
+            if (!tile.isNull()) {
+                info.painter->drawImage(QRectF(rect), tile);
+                continue;
+            }
+
+            // while decoding, stretch the part of a coarser cached tile
+            for (int coarse = level + 1; coarse < mTiles->levelCount(); coarse++) {
+                const int shift  = coarse - level;
+                auto      parent = mTiles->cachedTile(coarse, column >> shift, row >> shift);
+                if (parent.isNull()) {
+                    continue;
+                }
+
+                const auto   parentRect = mTiles->tileRect(coarse, column >> shift, row >> shift);
+                const double sx         = double(parent.width()) / parentRect.width();
+                const double sy         = double(parent.height()) / parentRect.height();
+                const QRectF source((rect.x() - parentRect.x()) * sx,
+                                    (rect.y() - parentRect.y()) * sy, rect.width() * sx,
+                                    rect.height() * sy);
+                info.painter->drawImage(QRectF(rect), parent, source);
+                break;
+            }
+        }
+    }
+}
+
+void ImageLabel::paintTextureTiles(const PaintInfo &info, const QImage &pixels,
+                                   const QRect &source) {
+    // the OpenGL engine uploads a whole image as one texture, cached by its key. fixed tiles
+    // viewing into the pixels keep the textures small and reused from frame to frame
+    if (pixels.constBits() != mTextureBits) {
+        mTextureTiles.clear();
+        mTextureBits = pixels.constBits();
+    }
+
+    const int columns = (pixels.width() + mTextureTileSize - 1) / mTextureTileSize;
+    const int rows    = (pixels.height() + mTextureTileSize - 1) / mTextureTileSize;
+    if (mTextureTiles.size() != columns * rows) {
+        mTextureTiles = QVector<QImage>(columns * rows);
+    }
+
+    const int bytesPerPixel = pixels.depth() / 8;
+    for (int row = source.top() / mTextureTileSize; row <= source.bottom() / mTextureTileSize;
+         row++) {
+        for (int column = source.left() / mTextureTileSize;
+             column <= source.right() / mTextureTileSize; column++) {
+            const auto rect = QRect(column * mTextureTileSize, row * mTextureTileSize,
+                                    mTextureTileSize, mTextureTileSize)
+                                  .intersected(pixels.rect());
+
+            auto &tile = mTextureTiles[ row * columns + column ];
+            if (tile.isNull()) {
+                tile = QImage(pixels.constScanLine(rect.top()) + rect.left() * bytesPerPixel,
+                              rect.width(), rect.height(), pixels.bytesPerLine(), pixels.format());
+            }
+
+            const auto part = source.intersected(rect);
+            info.painter->drawImage(part.topLeft(), tile, part.translated(-rect.topLeft()));
+        }
+    }
+}
+
+void ImageLabel::buildPyramid() {
+    // other formats are converted band by band while the levels are built
+    if (!::isHighDepth(mImage.format())) {
+        mPyramid->build(mImage);
+        return;
+    }
+
+    const auto low  = mWindowLow;
+    const auto high = mWindowHigh;
+    mPyramid->build(mImage,
+                    [ low, high ](const QImage &band) { return applyWindow(band, low, high); });
+}
+
+void ImageLabel::resetDisplay() {
+    // frames of a stream are written into the same buffer
+    mTextureTiles.clear();
+    mResampler->clear();
+    mDisplayValid = QBitArray();
+    if (mImage.isNull() || isDisplayFormat(mImage.format())) {
+        mDisplay = QImage();
+        return;
+    }
+
+    // converted lazily, tile by tile, only where the view looks at: windowed for high bit depth
+    // images, once into the display format for the others instead of by QPainter on every paint.
+    // mapped files and frames of a stream are never copied whole. frames reuse the buffer of the
+    // previous one
+    if (mDisplay.size() != mImage.size() || mDisplay.format() != displayFormat(mImage)) {
+        mDisplay = QImage(mImage.size(), displayFormat(mImage));
+    }
+    const int columns = (mImage.width() + mDisplayTileSize - 1) / mDisplayTileSize;
+    const int rows    = (mImage.height() + mDisplayTileSize - 1) / mDisplayTileSize;
+    mDisplayValid     = QBitArray(columns * rows);
+}
+
+void ImageLabel::updateDisplay(const QRectF &visible) {
+    const auto area = visible.toAlignedRect().intersected(mImage.rect());
+    if (area.isEmpty()) {
+        return;
+    }
+
+    const int columns   = (mImage.width() + mDisplayTileSize - 1) / mDisplayTileSize;
+    bool      converted = false;
+    for (int row = area.top() / mDisplayTileSize; row <= area.bottom() / mDisplayTileSize; row++) {
+        for (int column = area.left() / mDisplayTileSize;
+             column <= area.right() / mDisplayTileSize; column++) {
+            if (mDisplayValid.testBit(row * columns + column)) {
+                continue;
+            }
+
+            const QRect rect(column * mDisplayTileSize, row * mDisplayTileSize, mDisplayTileSize,
+                             mDisplayTileSize);
+            if (::isHighDepth(mImage.format())) {
+                applyWindow(mImage, rect, mDisplay, rect.topLeft(), mWindowLow, mWindowHigh);
+            } else {
+                toDisplayFormat(mImage, rect, mDisplay, rect.topLeft());
+            }
+            mDisplayValid.setBit(row * columns + column);
+            converted = true;
+
+            // the texture showing the old window is uploaded again
+            const int textureColumns = (mImage.width() + mTextureTileSize - 1) / mTextureTileSize;
+            const int texture =
+                rect.top() / mTextureTileSize * textureColumns + rect.left() / mTextureTileSize;
+            if (texture < mTextureTiles.size()) {
+                mTextureTiles[ texture ] = QImage();
+            }
+        }
+    }
+
+    if (converted) {
+        updateUsage();
+    }
+}
+
+void ImageLabel::evictDisplay() {
+    // only a plain format copy can go, painting then converts the original again. windowed
+    // pixels can not be drawn from the original
+    if (mDisplay.isNull() || ::isHighDepth(mImage.format())) {
+        return;
+    }
+
+    mTextureTiles.clear();
+    mDisplay      = QImage();
+    mDisplayValid = QBitArray();
+    updateUsage();
+}
+
+void ImageLabel::updateUsage() {
+    // the display copy is counted by the tiles written into it so far
+    const qint64 tileBytes = qint64(mDisplayTileSize) * mDisplayTileSize * 4;
+    mImageMemory.setUsage(mImage.sizeInBytes());
+    mDisplayMemory.setUsage(std::min<qint64>(mDisplay.sizeInBytes(),
+                                             mDisplayValid.count(true) * tileBytes));
+}
+
+QRectF ImageLabel::visibleRect(const PaintInfo &info) const {
+    const auto *painter = info.painter;
+    if (painter->hasClipping()) {
+        return painter->clipBoundingRect();
+    }
+
+    // viewport mapped back to image coordinates
+    return painter->worldTransform().inverted().mapRect(QRectF(painter->viewport()));
+}
@@ -1,8 +1,16 @@
 #pragma once
 
+#include "image/imagepyramid.h"
+#include "image/memorybudget.h"
+#include "image/pixelgrid.h"
+#include "image/tilecache.h"
+#include "image/viewresampler.h"
 #include "label.h"
 
+#include <QBitArray>
 #include <QImage>
+#include <QPair>
+#include <QVector>
 
 class ImageLabel : public Label {
 public:
@@ -10,8 +18,66 @@ public:
     void onPaint(const PaintInfo &info) override;
 
     void          setImage(const QImage &image);
+    // next frame of a stream, the window is kept and no mip levels are built
+    void          setFrame(const QImage &frame);
     const QImage &image() const;
+    // whole image as it is shown, windowed and in display format
+    QImage displayImage() const;
+
+    // on demand decoded image, image() stays null
+    void                       setTileSource(const QSharedPointer<TileSource> &source);
+    QSharedPointer<TileSource> tileSource() const;
+
+    QSize          size() const;
+    QImage::Format format() const;
+    bool           isNull() const;
+    QColor         pixelColor(const QPoint &pos) const;
+    // native samples, 16bit and float values are not scaled
+    QVector<double> pixelValues(const QPoint &pos) const;
+
+    // high bit depth images are shown through a window, samples in [low, high] map to 0..255
+    bool                  isHighDepth() const;
+    void                  setWindow(double low, double high);
+    void                  resetWindow();
+    QPair<double, double> window() const;
+
+    ImagePyramid *pyramid() const;
+    TileCache    *tileCache() const;
+
+    // resamples the last zoomed out view sharply in background, for when the view is idle.
+    // painting uses it until the view changes
+    ViewResampler *resampler() const;
+    void           sharpen();
+
+private:
+    void   paintTiles(const PaintInfo &info);
+    void   paintTextureTiles(const PaintInfo &info, const QImage &pixels, const QRect &source);
+    QRectF visibleRect(const PaintInfo &info) const;
+    void   buildPyramid();
+    void   resetDisplay();
+    void   updateDisplay(const QRectF &visible);
+    void   evictDisplay();
+    void   updateUsage();
 
 private:
-    QImage mImage;
-};
\ No newline at end of file
+    QImage                        mImage;
+    QImage                        mDisplay;      // display format copy, null if mImage is one
+    QBitArray                     mDisplayValid; // tiles of mDisplay converted so far
+    QSharedPointer<ImagePyramid>  mPyramid;
+    QSharedPointer<TileCache>     mTiles;
+    QSharedPointer<ViewResampler> mResampler;
+    BudgetClient                  mImageMemory;
+    BudgetClient                  mDisplayMemory;
+    PixelGrid                     mPixelGrid;
+    QVector<QImage>               mTextureTiles; // views into the pixels, OpenGL painting only
+    const uchar                  *mTextureBits = nullptr;
+    QTransform                    mSharpTransform; // last zoomed out view
+    QRect                         mSharpSource;
+    qreal                         mSharpRatio = 1.;
+
+    double       mWindowLow       = 0;
+    double       mWindowHigh      = 255;
+    const int    mDisplayTileSize = 256;
+    const int    mTextureTileSize = 2048;
+    const double mPixelGridScale  = 16.; // zoom drawn pixel by pixel
+};
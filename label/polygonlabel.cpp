@@ -1,4 +1,5 @@
 #include "polygonlabel.h"
+#include "paintbatch.h"
 #include "utils.h"
 
 PolygonLabel::PolygonLabel() = default;
@@ -13,17 +14,52 @@ void PolygonLabel::onPaint(const PaintInfo &info) {
     auto color = def->color();
     color.setAlpha(50);
     info.painter->setBrush(QBrush(color));
-    info.painter->drawPolygon(mPolygon);
+    info.painter->drawPolygon(mLod.polygon(mPolygon, info.worldScale));
 
     info.painter->restore();
 }
 
+QRectF PolygonLabel::boundingRect() const {
+    return mPolygon.boundingRect();
+}
+
+bool PolygonLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    batch.polygons.append(mLod.polygon(mPolygon, info.worldScale));
+    return true;
+}
+
 QPolygonF PolygonLabel::polygon() const {
     return mPolygon;
 }
 
 void PolygonLabel::setPolygon(const QPolygonF &value) {
     mPolygon = value;
+    touch();
+}
+
+// x y of each vertex
+QStringList PolygonLabel::serialize() const {
+    QVector<double> values;
+    for (const auto &point : mPolygon) {
+        values << point.x() << point.y();
+    }
+
+    return toStrings(values);
+}
+
+bool PolygonLabel::deserialize(const QStringList &source) {
+    // an empty one is written without values
+    auto values = toNumbers(source);
+    if (values.size() != source.size() || values.size() % 2 != 0) {
+        return false;
+    }
+
+    mPolygon.clear();
+    for (int i = 0; i < values.size(); i += 2) {
+        mPolygon.append({values[ i ], values[ i + 1 ]});
+    }
+    touch();
+    return true;
 }
 
 QPen PolygonLabel::getOutlinePen(const PaintInfo &info) const {
@@ -2,13 +2,18 @@
 #define POLYGONLABEL_H
 
 #include "label.h"
+#include "utils.h"
 #include <QPolygon>
 
 class PolygonLabel : public Label {
 public:
     PolygonLabel();
 
-    void onPaint(const PaintInfo &info) override;
+    void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
+    bool        batch(PaintBatch &batch, const PaintInfo &info) override;
+    QStringList serialize() const override;
+    bool        deserialize(const QStringList &source) override;
 
     QPolygonF polygon() const;
     void      setPolygon(const QPolygonF &value);
@@ -16,7 +21,8 @@ public:
     QPen getOutlinePen(const PaintInfo &info) const;
 
 private:
-    QPolygonF mPolygon;
+    QPolygonF  mPolygon;
+    PolygonLod mLod;
 };
 
 #endif // POLYGONLABEL_H
@@ -1,4 +1,5 @@
 #include "rectlabel.h"
+#include "paintbatch.h"
 #include "utils.h"
 
 RectLabel::RectLabel() = default;
@@ -14,12 +15,39 @@ void RectLabel::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RectLabel::boundingRect() const {
+    return mRect.normalized();
+}
+
+bool RectLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    Q_UNUSED(info)
+
+    batch.outlines.addRect(mRect);
+    return true;
+}
+
 QRectF RectLabel::rect() const {
     return mRect;
 }
 
 void RectLabel::setRect(const QRectF &value) {
     mRect = value;
+    touch();
+}
+
+// x y width height
+QStringList RectLabel::serialize() const {
+    return toStrings({mRect.x(), mRect.y(), mRect.width(), mRect.height()});
+}
+
+bool RectLabel::deserialize(const QStringList &source) {
+    auto values = toNumbers(source);
+    if (values.size() != 4) {
+        return false;
+    }
+
+    setRect(QRectF(values[ 0 ], values[ 1 ], values[ 2 ], values[ 3 ]));
+    return true;
 }
 
 QPen RectLabel::getOutlinePen(const PaintInfo &info) const {
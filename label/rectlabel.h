@@ -7,7 +7,11 @@ class RectLabel : public Label {
 public:
     RectLabel();
 
-    void onPaint(const PaintInfo &info) override;
+    void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
+    bool        batch(PaintBatch &batch, const PaintInfo &info) override;
+    QStringList serialize() const override;
+    bool        deserialize(const QStringList &source) override;
 
     QRectF rect() const;
     void   setRect(const QRectF &value);
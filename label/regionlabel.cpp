@@ -1,4 +1,18 @@
 #include "regionlabel.h"
+#include "paintbatch.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+// zoomed out, several rows fall on one screen row: each band of step rows is drawn as lines that
+// thick
+int decimationStep(double worldScale) {
+    return worldScale < 1. ? static_cast<int>(1. / worldScale) : 1;
+}
+} // namespace
 
 RegionLabel::RegionLabel() = default;
 
@@ -8,17 +22,107 @@ void RegionLabel::onPaint(const PaintInfo &info) {
     // rect
     auto pen = getOutlinePen(info);
     info.painter->setPen(pen);
-    info.painter->drawLines(mRegion);
+
+    const int step = decimationStep(info.worldScale);
+    if (step <= 1) {
+        info.painter->drawLines(mRegion);
+    } else {
+        pen.setWidthF(step);
+        info.painter->setPen(pen);
+        info.painter->drawLines(decimated(step));
+    }
 
     info.painter->restore();
 }
 
+QRectF RegionLabel::boundingRect() const {
+    return QPolygonF(mRegion).boundingRect();
+}
+
+bool RegionLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    const int step = decimationStep(info.worldScale);
+
+    batch.runs     += step <= 1 ? mRegion : decimated(step);
+    batch.runWidth  = step;
+    return true;
+}
+
 QVector<QPointF> RegionLabel::region() const {
     return mRegion;
 }
 
 void RegionLabel::setRegion(const QVector<QPointF> &value) {
     mRegion = value;
+    touch();
+}
+
+// x y of each point, pairs of points are the drawn runs
+QStringList RegionLabel::serialize() const {
+    QVector<double> values;
+    for (const auto &point : mRegion) {
+        values << point.x() << point.y();
+    }
+
+    return toStrings(values);
+}
+
+bool RegionLabel::deserialize(const QStringList &source) {
+    // an empty one is written without values
+    auto values = toNumbers(source);
+    if (values.size() != source.size() || values.size() % 2 != 0) {
+        return false;
+    }
+
+    mRegion.clear();
+    for (int i = 0; i < values.size(); i += 2) {
+        mRegion.append({values[ i ], values[ i + 1 ]});
+    }
+    touch();
+    return true;
+}
+
+const QVector<QPointF> &RegionLabel::decimated(int step) {
+    // shared data compares without looking at the points
+    if (step == mDecimatedStep && mRegion == mDecimatedSource) {
+        return mDecimated;
+    }
+
+    // the runs of all rows of a band, by their first and last column
+    struct Run {
+        int    band;
+        double left;
+        double right;
+    };
+    QVector<Run> runs;
+    runs.reserve(mRegion.size() / 2);
+    for (int i = 0; i + 1 < mRegion.size(); i += 2) {
+        const auto &p0 = mRegion[ i ];
+        const auto &p1 = mRegion[ i + 1 ];
+        runs.append({static_cast<int>(std::floor(p0.y() / step)), std::min(p0.x(), p1.x()),
+                     std::max(p0.x(), p1.x())});
+    }
+    std::sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) {
+        return std::tie(a.band, a.left) < std::tie(b.band, b.left);
+    });
+
+    // the union of each band, overlapping and adjacent runs are one line through its middle
+    mDecimated.clear();
+    const double center = (step - 1) / 2.;
+    for (int i = 0; i < runs.size();) {
+        auto merged = runs[ i++ ];
+        while (i < runs.size() && runs[ i ].band == merged.band &&
+               runs[ i ].left <= merged.right + 1.) {
+            merged.right = std::max(merged.right, runs[ i++ ].right);
+        }
+
+        const double y = merged.band * step + center;
+        mDecimated.append(QPointF(merged.left, y));
+        mDecimated.append(QPointF(merged.right, y));
+    }
+    mDecimatedStep   = step;
+    mDecimatedSource = mRegion;
+
+    return mDecimated;
 }
 
 QPen RegionLabel::getOutlinePen(const PaintInfo &info) const {
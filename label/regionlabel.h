@@ -7,15 +7,26 @@ class RegionLabel : public Label {
 public:
     RegionLabel();
 
-    void onPaint(const PaintInfo &info) override;
+    void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
+    bool        batch(PaintBatch &batch, const PaintInfo &info) override;
+    QStringList serialize() const override;
+    bool        deserialize(const QStringList &source) override;
 
     QVector<QPointF> region() const;
     void             setRegion(const QVector<QPointF> &value);
 
     QPen getOutlinePen(const PaintInfo &info) const;
 
+private:
+    // runs merged over bands of step rows, cached for the zoom
+    const QVector<QPointF> &decimated(int step);
+
 private:
     QVector<QPointF> mRegion;
+    QVector<QPointF> mDecimated;
+    QVector<QPointF> mDecimatedSource;
+    int              mDecimatedStep = 0;
 };
 
 #endif // REGIONLABEL_H
\ No newline at end of file
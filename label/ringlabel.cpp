@@ -1,8 +1,11 @@
 #include "ringlabel.h"
+#include "paintbatch.h"
 #include "utils.h"
 
 #include <QPainterPath>
 
+#include <algorithm>
+
 RingLabel::RingLabel() = default;
 
 void RingLabel::onPaint(const PaintInfo &info) {
@@ -23,6 +26,21 @@ void RingLabel::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RingLabel::boundingRect() const {
+    const auto radius = std::max(mInsideRadius, mOutsideRadius);
+    return {mCenter.x() - radius, mCenter.y() - radius, radius * 2, radius * 2};
+}
+
+bool RingLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    Q_UNUSED(info)
+
+    QPainterPath path;
+    path.addEllipse(mCenter, mInsideRadius, mInsideRadius);
+    path.addEllipse(mCenter, mOutsideRadius, mOutsideRadius);
+    batch.paths.append(path);
+    return true;
+}
+
 double RingLabel::insideRadius() const {
     return mInsideRadius;
 }
@@ -39,6 +57,22 @@ void RingLabel::setRing(const QPointF &center, double insideRadius, double outsi
     mInsideRadius  = insideRadius;
     mOutsideRadius = outsideRadius;
     mCenter        = center;
+    touch();
+}
+
+// center x, center y, inside radius, outside radius
+QStringList RingLabel::serialize() const {
+    return toStrings({mCenter.x(), mCenter.y(), mInsideRadius, mOutsideRadius});
+}
+
+bool RingLabel::deserialize(const QStringList &source) {
+    auto values = toNumbers(source);
+    if (values.size() != 4) {
+        return false;
+    }
+
+    setRing({values[ 0 ], values[ 1 ]}, values[ 2 ], values[ 3 ]);
+    return true;
 }
 
 QPen RingLabel::getOutlinePen(const PaintInfo &info) const {
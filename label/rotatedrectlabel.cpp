@@ -1,4 +1,5 @@
 #include "rotatedrectlabel.h"
+#include "paintbatch.h"
 #include "utils.h"
 
 #include <QTransform>
@@ -18,6 +19,18 @@ void RotatedRectLabel::onPaint(const PaintInfo &info) {
     info.painter->restore();
 }
 
+QRectF RotatedRectLabel::boundingRect() const {
+    return mRectPoints.boundingRect();
+}
+
+bool RotatedRectLabel::batch(PaintBatch &batch, const PaintInfo &info) {
+    Q_UNUSED(info)
+
+    batch.outlines.addPolygon(mRectPoints);
+    batch.outlines.closeSubpath();
+    return true;
+}
+
 double RotatedRectLabel::angle() const {
     return mAngle;
 }
@@ -50,6 +63,22 @@ void RotatedRectLabel::updateRotatedRect(const QRectF &rect, double angle) {
     mRect  = rect;
     mAngle = angle;
     updatePoint();
+    touch();
+}
+
+// x y width height of the unrotated rect, angle in degrees
+QStringList RotatedRectLabel::serialize() const {
+    return toStrings({mRect.x(), mRect.y(), mRect.width(), mRect.height(), mAngle});
+}
+
+bool RotatedRectLabel::deserialize(const QStringList &source) {
+    auto values = toNumbers(source);
+    if (values.size() != 5) {
+        return false;
+    }
+
+    setRotatedRect(QRectF(values[ 0 ], values[ 1 ], values[ 2 ], values[ 3 ]), values[ 4 ]);
+    return true;
 }
 
 QPen RotatedRectLabel::getOutlinePen(const PaintInfo &info) const {
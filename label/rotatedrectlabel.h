@@ -9,7 +9,11 @@ class RotatedRectLabel : public Label {
 public:
     RotatedRectLabel();
 
-    void onPaint(const PaintInfo &info) override;
+    void        onPaint(const PaintInfo &info) override;
+    QRectF      boundingRect() const override;
+    bool        batch(PaintBatch &batch, const PaintInfo &info) override;
+    QStringList serialize() const override;
+    bool        deserialize(const QStringList &source) override;
 
     double angle() const;
     QRectF rect() const;
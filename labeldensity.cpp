@@ -0,0 +1,172 @@
+#include "labeldensity.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+void LabelDensity::setImageSize(const QSize &size) {
+    if (size == mImageSize) {
+        return;
+    }
+
+    // cells are a power of two pixels wide, at most mMaxGridSize of them on the long side
+    mImageSize = size;
+    mCellSize  = 1;
+    while (std::max(size.width(), size.height()) > mCellSize * mMaxGridSize) {
+        mCellSize *= 2;
+    }
+    mGridSize = QSize((size.width() + mCellSize - 1) / mCellSize,
+                      (size.height() + mCellSize - 1) / mCellSize);
+
+    mGrids.clear();
+    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+        it->category = it.key()->category().data();
+        it->cell     = cellOf(*it.key());
+        count(*it, it.key()->category(), 1);
+    }
+}
+
+void LabelDensity::add(const Label &label) {
+    if (mEntries.contains(&label)) {
+        update(label);
+        return;
+    }
+
+    const Entry entry{label.category().data(), cellOf(label)};
+    mEntries.insert(&label, entry);
+    count(entry, label.category(), 1);
+}
+
+void LabelDensity::remove(const Label &label) {
+    auto it = mEntries.find(&label);
+    if (it == mEntries.end()) {
+        return;
+    }
+
+    count(*it, {}, -1);
+    mEntries.erase(it);
+}
+
+void LabelDensity::update(const Label &label) {
+    remove(label);
+    add(label);
+}
+
+void LabelDensity::clear() {
+    mEntries.clear();
+    mGrids.clear();
+}
+
+void LabelDensity::paint(QPainter *painter, double worldScale) {
+    if (mGrids.isEmpty()) {
+        return;
+    }
+
+    // a drawn cell is 2^level grid cells, at least mScreenCell pixels on screen
+    int level = 0;
+    while (level < 16 && (mCellSize << level) * worldScale < mScreenCell) {
+        level++;
+    }
+
+    QVector<Grid *> grids;
+    for (auto &grid : mGrids) {
+        grids.append(&grid);
+    }
+    std::sort(grids.begin(), grids.end(),
+              [](const Grid *a, const Grid *b) { return a->category->id() < b->category->id(); });
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    for (auto *grid : grids) {
+        if (!grid->category->visible()) {
+            continue;
+        }
+
+        if (grid->dirty || grid->level != level || grid->color != grid->category->color().rgba()) {
+            render(*grid, level);
+        }
+
+        const auto span = double(mCellSize << level);
+        painter->drawImage(
+            QRectF(0, 0, grid->image.width() * span, grid->image.height() * span), grid->image);
+    }
+    painter->restore();
+}
+
+int LabelDensity::cellOf(const Label &label) const {
+    const auto box = label.boundingRect();
+    if (box.isNull() || mGridSize.isEmpty()) {
+        return -1;
+    }
+
+    const auto center = box.center();
+    const auto x      = static_cast<int>(std::floor(center.x() / mCellSize));
+    const auto y      = static_cast<int>(std::floor(center.y() / mCellSize));
+    if (x < 0 || y < 0 || x >= mGridSize.width() || y >= mGridSize.height()) {
+        return -1;
+    }
+
+    return y * mGridSize.width() + x;
+}
+
+void LabelDensity::count(const Entry &entry, const QSharedPointer<LabelCategory> &category,
+                         int delta) {
+    if (entry.cell < 0 || !entry.category) {
+        return;
+    }
+
+    auto it = mGrids.find(entry.category);
+    if (it == mGrids.end()) {
+        if (delta < 0) {
+            return;
+        }
+
+        it           = mGrids.insert(entry.category, {});
+        it->category = category;
+        it->counts.resize(mGridSize.width() * mGridSize.height());
+    }
+
+    it->counts[ entry.cell ] += delta;
+    it->total                += delta;
+    it->dirty                 = true;
+    if (it->total <= 0) {
+        mGrids.erase(it);
+    }
+}
+
+void LabelDensity::render(Grid &grid, int level) const {
+    const int span   = 1 << level;
+    const int width  = (mGridSize.width() + span - 1) / span;
+    const int height = (mGridSize.height() + span - 1) / span;
+
+    QVector<int> sums(width * height);
+    for (int y = 0; y < mGridSize.height(); y++) {
+        const auto *counts = grid.counts.constData() + y * mGridSize.width();
+        auto       *row    = sums.data() + (y >> level) * width;
+        for (int x = 0; x < mGridSize.width(); x++) {
+            row[ x >> level ] += counts[ x ];
+        }
+    }
+
+    // log scale, single labels stay visible next to dense clusters
+    const int    maxSum = std::max(1, *std::max_element(sums.cbegin(), sums.cend()));
+    const double norm   = 1. / std::log1p(double(maxSum));
+    const auto   color  = grid.category->color();
+
+    grid.image = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < height; y++) {
+        auto       *pixels = reinterpret_cast<QRgb *>(grid.image.scanLine(y));
+        const auto *row    = sums.constData() + y * width;
+        for (int x = 0; x < width; x++) {
+            const int alpha =
+                row[ x ] > 0 ? static_cast<int>(40. + 200. * std::log1p(double(row[ x ])) * norm)
+                             : 0;
+            pixels[ x ] = qPremultiply(qRgba(color.red(), color.green(), color.blue(), alpha));
+        }
+    }
+
+    grid.level = level;
+    grid.color = color.rgba();
+    grid.dirty = false;
+}
@@ -0,0 +1,59 @@
+#ifndef LABELDENSITY_H
+#define LABELDENSITY_H
+
+#include "label.h"
+
+#include <QHash>
+#include <QImage>
+#include <QSharedPointer>
+#include <QVector>
+
+// label counts per category on a grid over the image, kept up to date as labels come and go.
+// far zoomed out it is drawn instead of the labels, as a density map per category. the cost
+// depends on the grid size, not on the label count.
+class LabelDensity {
+public:
+    // labels are binned again
+    void setImageSize(const QSize &size);
+
+    void add(const Label &label);
+    void remove(const Label &label);
+    // after a label moved or changed its category
+    void update(const Label &label);
+    void clear();
+
+    // the painter has the world transform, visible categories are drawn in id order
+    void paint(QPainter *painter, double worldScale);
+
+private:
+    struct Grid {
+        QSharedPointer<LabelCategory> category;
+        QVector<int>                  counts;
+        int                           total = 0;
+        QImage                        image;      // coarse counts as colors
+        int                           level = -1; // log2 of the grid cells per drawn cell
+        QRgb                          color = 0;  // of the category when rendered
+        bool                          dirty = true;
+    };
+
+    struct Entry {
+        LabelCategory *category = nullptr;
+        int            cell     = -1; // -1 outside of the grid
+    };
+
+    int  cellOf(const Label &label) const;
+    void count(const Entry &entry, const QSharedPointer<LabelCategory> &category, int delta);
+    void render(Grid &grid, int level) const;
+
+private:
+    QSize                        mImageSize;
+    QSize                        mGridSize;
+    int                          mCellSize = 1; // image pixels
+    QHash<const Label *, Entry>  mEntries;
+    QHash<LabelCategory *, Grid> mGrids;
+
+    const int mMaxGridSize = 1024; // cells on the long side
+    const int mScreenCell  = 8;    // pixels, smallest drawn cell
+};
+
+#endif // LABELDENSITY_H
@@ -0,0 +1,164 @@
+#include "labelfile.h"
+#include "label/circlelabel.h"
+#include "label/polygonlabel.h"
+#include "label/rectlabel.h"
+#include "label/regionlabel.h"
+#include "label/ringlabel.h"
+#include "label/rotatedrectlabel.h"
+
+#include <QFile>
+#include <QHash>
+#include <QTextStream>
+
+namespace {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+const auto skipEmpty = Qt::SkipEmptyParts;
+#else
+const auto skipEmpty = QString::SkipEmptyParts;
+#endif
+} // namespace
+
+bool readLabelFile(const QString &filepath, LabelFile &file, QString *error) {
+    QFile device(filepath);
+    if (!device.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) {
+            *error = device.errorString();
+        }
+        return false;
+    }
+
+    QHash<int, QSharedPointer<LabelCategory>> categories;
+    QTextStream                               stream(&device);
+    int                                       lineNumber = 0;
+    while (!stream.atEnd()) {
+        const auto line = stream.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        const auto fields = line.split(' ', skipEmpty);
+        bool       ok     = fields.size() >= 2;
+        const int  id     = ok ? fields[ 1 ].toInt(&ok) : 0;
+        if (ok && fields[ 0 ] == "category") {
+            QColor    color(fields.value(2));
+            const int lineWidth = fields.value(3).toInt(&ok);
+            if (ok && color.isValid()) {
+                QSharedPointer<LabelCategory> category(new LabelCategory);
+                category->setId(id);
+                category->setColor(color);
+                category->setLineWidth(lineWidth);
+                category->setName(fields.mid(4).join(' '));
+                categories.insert(id, category);
+                file.categories.append(category);
+                continue;
+            }
+        } else if (ok) {
+            auto label = createLabel(fields[ 0 ]);
+            if (label && label->deserialize(fields.mid(2))) {
+                if (categories.contains(id)) {
+                    label->setCategory(categories.value(id));
+                }
+                file.labels.append(label);
+                continue;
+            }
+        }
+
+        if (error) {
+            *error = QString("%1:%2: invalid line").arg(filepath).arg(lineNumber);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool writeLabelFile(const QString &filepath, const QList<QSharedPointer<Label>> &labels,
+                    QString *error) {
+    QFile device(filepath);
+    if (!device.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) {
+            *error = device.errorString();
+        }
+        return false;
+    }
+
+    QTextStream            stream(&device);
+    QList<LabelCategory *> written;
+    for (const auto &label : labels) {
+        auto *category = label->category().data();
+        if (labelType(*label).isEmpty() || !category || written.contains(category)) {
+            continue;
+        }
+
+        written.append(category);
+        stream << "category " << category->id() << ' ' << category->color().name() << ' '
+               << category->lineWidth() << ' ' << category->name() << '\n';
+    }
+
+    for (const auto &label : labels) {
+        const auto type = labelType(*label);
+        if (type.isEmpty()) {
+            continue;
+        }
+
+        const auto id = label->category() ? label->category()->id() : 0;
+        stream << type << ' ' << id << ' ' << label->serialize().join(' ') << '\n';
+    }
+
+    stream.flush();
+    if (device.error() != QFile::NoError) {
+        if (error) {
+            *error = device.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+QSharedPointer<Label> createLabel(const QString &type) {
+    if (type == "rect") {
+        return QSharedPointer<RectLabel>(new RectLabel);
+    }
+    if (type == "rotatedrect") {
+        return QSharedPointer<RotatedRectLabel>(new RotatedRectLabel);
+    }
+    if (type == "circle") {
+        return QSharedPointer<CircleLabel>(new CircleLabel);
+    }
+    if (type == "ring") {
+        return QSharedPointer<RingLabel>(new RingLabel);
+    }
+    if (type == "polygon") {
+        return QSharedPointer<PolygonLabel>(new PolygonLabel);
+    }
+    if (type == "region") {
+        return QSharedPointer<RegionLabel>(new RegionLabel);
+    }
+
+    return {};
+}
+
+QString labelType(const Label &label) {
+    if (dynamic_cast<const RectLabel *>(&label)) {
+        return "rect";
+    }
+    if (dynamic_cast<const RotatedRectLabel *>(&label)) {
+        return "rotatedrect";
+    }
+    if (dynamic_cast<const CircleLabel *>(&label)) {
+        return "circle";
+    }
+    if (dynamic_cast<const RingLabel *>(&label)) {
+        return "ring";
+    }
+    if (dynamic_cast<const PolygonLabel *>(&label)) {
+        return "polygon";
+    }
+    if (dynamic_cast<const RegionLabel *>(&label)) {
+        return "region";
+    }
+
+    return {};
+}
@@ -0,0 +1,28 @@
+#ifndef LABELFILE_H
+#define LABELFILE_H
+
+#include "label.h"
+
+#include <QList>
+#include <QSharedPointer>
+
+// labels of an image as text, one item per line:
+//   category <id> <#rrggbb> <line width> <name>
+//   <type> <category id> <values of Label::serialize>
+// types are rect, rotatedrect, circle, ring, polygon and region, lines starting with '#' are
+// comments. labels of an undeclared category keep the default one.
+struct LabelFile {
+    QList<QSharedPointer<LabelCategory>> categories;
+    QList<QSharedPointer<Label>>         labels;
+};
+
+bool readLabelFile(const QString &filepath, LabelFile &file, QString *error = nullptr);
+bool writeLabelFile(const QString &filepath, const QList<QSharedPointer<Label>> &labels,
+                    QString *error = nullptr);
+
+// null for unknown types
+QSharedPointer<Label> createLabel(const QString &type);
+// empty for labels that can not be written, editors and the image
+QString labelType(const Label &label);
+
+#endif // LABELFILE_H
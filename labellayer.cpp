@@ -0,0 +1,142 @@
+#include "labellayer.h"
+#include "paintbatch.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+void LabelLayer::invalidate() {
+    mWhole = true;
+    mDirty = QRegion();
+}
+
+void LabelLayer::invalidate(const QRect &rect) {
+    if (!mWhole) {
+        mDirty += rect;
+    }
+}
+
+bool LabelLayer::paint(QPainter *painter, const QVector<Label *> &labels, const PaintInfo &info,
+                       const QTransform &transform, const Bounds &bounds) {
+    const auto *device = painter->device();
+    const auto  ratio  = device->devicePixelRatioF();
+    const QSize size(qRound(device->width() * ratio), qRound(device->height() * ratio));
+    if (mImage.size() != size) {
+        mImage = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        mImage.setDevicePixelRatio(ratio);
+        mScratch = QImage();
+        invalidate();
+    } else if (mTransform != transform && !scroll(transform)) {
+        invalidate();
+    }
+    mTransform = transform;
+
+    quint64 revision = 0;
+    for (const auto *label : labels) {
+        revision = std::max(revision, label->revision());
+    }
+    if (labels != mLabels || revision > mRevision) {
+        invalidate();
+    }
+
+    const bool redraw = mWhole || !mDirty.isEmpty();
+    if (redraw) {
+        if (mWhole) {
+            mImage.fill(Qt::transparent);
+        }
+
+        QPainter layer(&mImage);
+        if (!mWhole) {
+            layer.setClipRegion(mDirty);
+            layer.setCompositionMode(QPainter::CompositionMode_Clear);
+            layer.fillRect(mDirty.boundingRect(), Qt::transparent);
+            layer.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        }
+
+        layer.setRenderHints(painter->renderHints());
+        layer.setFont(painter->font());
+        layer.setTransform(transform);
+
+        auto layerInfo    = info;
+        layerInfo.painter = &layer;
+
+        // labels outside of the view are skipped, labels smaller than a few screen pixels are
+        // a dot each. plain labels are batched by style, editors are painted alone on top
+        const QRect      area(0, 0, device->width(), device->height());
+        PaintBatch       batch;
+        QVector<Label *> single;
+        batch.dotSize = mMinLabelPixels;
+        for (auto *label : labels) {
+            const auto rect = bounds(*label);
+            if (!(mWhole ? area.intersects(rect) : mDirty.intersects(rect))) {
+                continue;
+            }
+
+            const auto box = label->boundingRect();
+            if (!box.isNull() &&
+                std::max(box.width(), box.height()) * info.worldScale < mMinLabelPixels) {
+                batch.dots.append(box.center());
+                continue;
+            }
+
+            if (!label->batch(batch, layerInfo)) {
+                single.append(label);
+            }
+        }
+
+        if (!labels.isEmpty()) {
+            batch.paint(&layer, *labels.first()->category(), info.worldScale);
+        }
+        for (auto *label : single) {
+            label->onPaint(layerInfo);
+        }
+
+        mWhole    = false;
+        mDirty    = QRegion();
+        mLabels   = labels;
+        mRevision = revision;
+    }
+
+    painter->save();
+    painter->resetTransform();
+    painter->drawImage(QPointF(0, 0), mImage);
+    painter->restore();
+    return redraw;
+}
+
+qint64 LabelLayer::sizeInBytes() const {
+    return mImage.sizeInBytes() + mScratch.sizeInBytes();
+}
+
+bool LabelLayer::scroll(const QTransform &transform) {
+    // only a pan by whole device pixels keeps the rasterised labels valid
+    const auto ratio = mImage.devicePixelRatio();
+    const QPointF shift(transform.dx() - mTransform.dx(), transform.dy() - mTransform.dy());
+    const auto    delta = shift.toPoint();
+    const auto    whole = [](double value) { return std::abs(value - std::round(value)) < 1e-3; };
+    if (mWhole || !qFuzzyCompare(transform.m11(), mTransform.m11()) ||
+        !qFuzzyCompare(transform.m22(), mTransform.m22()) || !whole(shift.x()) ||
+        !whole(shift.y()) || !whole(shift.x() * ratio) || !whole(shift.y() * ratio)) {
+        return false;
+    }
+
+    if (mScratch.size() != mImage.size()) {
+        mScratch = QImage(mImage.size(), mImage.format());
+        mScratch.setDevicePixelRatio(ratio);
+    }
+
+    {
+        QPainter painter(&mScratch);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(QPointF(delta), mImage);
+    }
+    mImage.swap(mScratch);
+
+    // the uncovered strips hold stale pixels of the scratch image
+    const QRect area(QPoint(0, 0), (QSizeF(mImage.size()) / ratio).toSize());
+    mDirty.translate(delta);
+    mDirty &= area;
+    mDirty += QRegion(area).subtracted(area.translated(delta));
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef LABELLAYER_H
+#define LABELLAYER_H
+
+#include "label.h"
+
+#include <QImage>
+#include <QRegion>
+#include <QTransform>
+#include <QVector>
+
+#include <functional>
+
+// labels of one category rasterised at the current view. only invalidated parts and the parts
+// uncovered by panning are drawn again, otherwise painting the layer is a single blit.
+// zoomed out, tiny labels are reduced to dots. plain labels are drawn in batches by style.
+class LabelLayer {
+public:
+    // widget area painted by a label
+    using Bounds = std::function<QRect(const Label &)>;
+
+    void invalidate();
+    void invalidate(const QRect &rect);
+
+    // brings the layer up to date with `labels` at `transform` and draws it. a changed list,
+    // or a label touched since the last draw, redraws all of it. false if it was a plain blit
+    bool paint(QPainter *painter, const QVector<Label *> &labels, const PaintInfo &info,
+               const QTransform &transform, const Bounds &bounds);
+
+    qint64 sizeInBytes() const;
+
+private:
+    bool scroll(const QTransform &transform);
+
+private:
+    QImage           mImage;
+    QImage           mScratch; // previous image while scrolling
+    QRegion          mDirty;
+    bool             mWhole = true;
+    QTransform       mTransform;
+    QVector<Label *> mLabels;       // drawn into the layer, in order
+    quint64          mRevision = 0; // newest label revision drawn
+
+    const double mMinLabelPixels = 2.; // smaller labels are drawn as a dot
+};
+
+#endif // LABELLAYER_H
@@ -1,10 +1,145 @@
+#include "batch/batchrenderer.h"
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QImageReader>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+bool hasArgument(int argc, char *argv[], const char *name) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[ i ], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList imageFiles(const QStringList &paths) {
+    QStringList filters;
+    for (const auto &format : QImageReader::supportedImageFormats()) {
+        filters.append("*." + QString::fromLatin1(format));
+    }
+    filters << "*.npy"
+            << "*.raw";
+
+    QStringList files;
+    for (const auto &path : paths) {
+        QFileInfo info(path);
+        if (!info.isDir()) {
+            files.append(info.absoluteFilePath());
+            continue;
+        }
+
+        QDir dir(path);
+        for (const auto &name : dir.entryList(filters, QDir::Files, QDir::Name)) {
+            files.append(dir.absoluteFilePath(name));
+        }
+    }
+
+    files.removeDuplicates();
+    return files;
+}
+
+// viewer --batch [--labels dir] [--output dir] [--threads n] images or folders...
+// labels of a.png are read from a.txt, the image folder if no label folder is given. images
+// are rendered to <output>/a.png, two images of the same base name are an error
+int runBatch(const QCoreApplication &app) {
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"batch", "render labels into images without a window"});
+    parser.addOption({"labels", "folder of the label files", "dir"});
+    parser.addOption({"output", "folder of the rendered images", "dir", "rendered"});
+    parser.addOption({"threads", "worker threads, all cores by default", "count", "0"});
+    parser.addPositionalArgument("images", "image files or folders");
+    parser.process(app);
+
+    QDir output(parser.value("output"));
+    if (!output.mkpath(".")) {
+        std::fprintf(stderr, "can not create %s\n", qPrintable(output.path()));
+        return 1;
+    }
+
+    // workers would race on a shared output file, one of the images would be lost
+    QList<BatchJob>         jobs;
+    QHash<QString, QString> sources; // image per output
+    for (const auto &file : imageFiles(parser.positionalArguments())) {
+        QFileInfo info(file);
+        QDir      labels(parser.isSet("labels") ? parser.value("labels") : info.absolutePath());
+
+        BatchJob job;
+        job.image  = file;
+        job.labels = labels.absoluteFilePath(info.completeBaseName() + ".txt");
+        job.output = output.absoluteFilePath(info.completeBaseName() + ".png");
+        if (sources.contains(job.output)) {
+            std::fprintf(stderr, "%s and %s are both rendered to %s\n",
+                         qPrintable(sources.value(job.output)), qPrintable(file),
+                         qPrintable(job.output));
+            return 1;
+        }
+        sources.insert(job.output, file);
+        jobs.append(job);
+    }
+
+    if (jobs.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const auto report =
+        renderBatch(jobs, parser.value("threads").toInt(), [](int done, int total) {
+            std::fprintf(stderr, "\r%d/%d", done, total);
+        });
+
+    std::fprintf(stderr, "\n");
+    for (const auto &error : report.errors) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+    }
+    std::printf("%d rendered, %d failed in %.2fs, %.1f images/s\n", report.rendered,
+                report.failed, double(report.elapsedMs) / 1000., report.imagesPerSecond());
+
+    return report.failed == 0 ? 0 : 1;
+}
+} // namespace
 
 int main(int argc, char *argv[]) {
+    // batch rendering needs no display
+    if (hasArgument(argc, argv, "--batch")) {
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+
+        QGuiApplication app(argc, argv);
+        return runBatch(app);
+    }
+
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"shm", "show live frames of a shared memory ring", "name"});
+    parser.addOption({"batch", "render labels into images without a window, see --batch --help"});
+    parser.addOption({"opengl", "paint through OpenGL, software rendering with Mesa works too"});
+    parser.addPositionalArgument("image", "image to open");
+    parser.process(a);
+
     MainWindow w;
     w.show();
+
+    if (parser.isSet("opengl")) {
+        w.setOpenGL(true);
+    }
+
+    if (parser.isSet("shm")) {
+        w.attachStream(parser.value("shm"));
+    } else if (!parser.positionalArguments().isEmpty()) {
+        w.openImage(parser.positionalArguments().first());
+    }
+
     return a.exec();
 }
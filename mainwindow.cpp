@@ -6,18 +6,24 @@
 #include "editor/regioneditor.h"
 #include "editor/ringeditor.h"
 #include "editor/rotatedrecteditor.h"
+#include "image/imageprefetcher.h"
 #include "label/circlelabel.h"
 #include "label/polygonlabel.h"
 #include "label/rectlabel.h"
 #include "label/regionlabel.h"
 #include "label/ringlabel.h"
 #include "label/rotatedrectlabel.h"
+#ifdef Q_OS_UNIX
+#include "stream/shmframesource.h"
+#endif
 
 #include <QAction>
 #include <QActionGroup>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QFontDatabase>
 #include <QLabel>
+#include <QStatusBar>
 #include <QToolButton>
 #include <qmath.h>
 
@@ -42,7 +48,8 @@ enum ICON {
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , mUi(new Ui::MainWindow)
-    , mViewer(new ImageViewer) {
+    , mViewer(new ImageViewer)
+    , mPrefetcher(new ImagePrefetcher(this)) {
     mUi->setupUi(this);
 
     // icon
@@ -103,6 +110,23 @@ MainWindow::MainWindow(QWidget *parent)
 
     mUi->toolBar->addWidget(toolBtn);
 
+    // folder navigation
+    auto *actionPrevious = new QAction(QString(QChar(0x25c0)), this);
+    auto *actionNext     = new QAction(QString(QChar(0x25b6)), this);
+    actionPrevious->setToolTip("previous image");
+    actionNext->setToolTip("next image");
+    actionPrevious->setShortcuts({QKeySequence(Qt::Key_PageUp), QKeySequence(Qt::Key_Left)});
+    actionNext->setShortcuts({QKeySequence(Qt::Key_PageDown), QKeySequence(Qt::Key_Right)});
+    mUi->toolBar->insertAction(mUi->actionScaleUp, actionPrevious);
+    mUi->toolBar->insertAction(mUi->actionScaleUp, actionNext);
+    mUi->toolBar->insertSeparator(mUi->actionScaleUp);
+
+    // paint timings over the info text
+    auto *actionPaintStats = new QAction(tr("paint stats"), this);
+    actionPaintStats->setCheckable(true);
+    actionPaintStats->setShortcut(QKeySequence(Qt::Key_F12));
+    addAction(actionPaintStats);
+
     // viewer
     setCentralWidget(mViewer);
 
@@ -112,9 +136,23 @@ MainWindow::MainWindow(QWidget *parent)
             &ImageViewer::resetToOriginalSize);
     connect(mUi->actionOpenFile, &QAction::triggered, this, &MainWindow::openFile);
     connect(mUi->actionSaveFile, &QAction::triggered, this, &MainWindow::saveFile);
+    connect(actionPrevious, &QAction::triggered, this, &MainWindow::previousImage);
+    connect(actionNext, &QAction::triggered, this, &MainWindow::nextImage);
+    connect(mPrefetcher, &ImagePrefetcher::prefetched, this, &MainWindow::onPrefetched);
     connect(mUi->actionScaleUp, &QAction::triggered, mViewer, &ImageViewer::zoomIn);
     connect(mUi->actionScaleDown, &QAction::triggered, mViewer, &ImageViewer::zoomOut);
     connect(mUi->actionPixelPicker, &QAction::triggered, mViewer, &ImageViewer::setInSelect);
+    connect(actionPaintStats, &QAction::toggled, mViewer, &ImageViewer::setShowPaintStats);
+    connect(mViewer, &ImageViewer::loadProgress, this,
+            [ this ](int percent) { statusBar()->showMessage(tr("loading %1%").arg(percent)); });
+    connect(mViewer, &ImageViewer::loadFinished, this, [ this ](const QString &path, bool success) {
+        if (success) {
+            statusBar()->clearMessage();
+        } else {
+            statusBar()->showMessage(tr("failed to load %1").arg(path), 3000);
+        }
+    });
+    connect(mViewer, &ImageViewer::loadCanceled, this, [ this ]() { statusBar()->clearMessage(); });
     connect(toolBtn, &QToolButton::triggered,
             [ toolBtn ](QAction *action) { toolBtn->setDefaultAction(action); });
     connect(actionCircle, &QAction::triggered,
@@ -139,12 +177,104 @@ MainWindow::~MainWindow() {
 
 void MainWindow::openFile() {
     auto filepath = QFileDialog::getOpenFileName(
-        this, tr("Open image"), "", tr("Image File(*.png *.jpg *.jpeg *.bmp *.tif);;All Files(*)"));
+        this, tr("Open image"), "",
+        tr("Image File(*.png *.jpg *.jpeg *.bmp *.tif *.pgm *.ppm *.npy *.raw);;All Files(*)"));
     if (filepath.isEmpty()) {
         return;
     }
 
-    if (mViewer != nullptr) {
+    openImage(filepath);
+}
+
+void MainWindow::openImage(const QString &filepath) {
+    if (mViewer == nullptr) {
+        return;
+    }
+
+    detachStream();
+    mPrefetcher->setCurrentFile(filepath);
+    setWindowTitle(QFileInfo(filepath).fileName());
+
+    auto current = mPrefetcher->currentFile();
+    auto image   = mPrefetcher->cachedImage(current);
+    if (!image.isNull()) {
+        mWaitingFile.clear();
+        mViewer->cancelLoad();
+        mViewer->setImage(image);
+    } else if (mPrefetcher->isPending(current)) {
+        // still decoding from when it was a neighbour, do not decode it twice
+        mWaitingFile = current;
+        mViewer->cancelLoad();
+    } else {
+        mWaitingFile.clear();
+        mViewer->loadImage(current);
+    }
+}
+
+void MainWindow::nextImage() {
+    auto filepath = mPrefetcher->neighbour(1);
+    if (!filepath.isEmpty()) {
+        openImage(filepath);
+    }
+}
+
+void MainWindow::previousImage() {
+    auto filepath = mPrefetcher->neighbour(-1);
+    if (!filepath.isEmpty()) {
+        openImage(filepath);
+    }
+}
+
+bool MainWindow::attachStream(const QString &name) {
+#ifdef Q_OS_UNIX
+    if (!mStream) {
+        mStream = new ShmFrameSource(this);
+        connect(mStream, &ShmFrameSource::frameReady, mViewer, &ImageViewer::presentFrame);
+    }
+
+    if (!mStream->attach(name)) {
+        statusBar()->showMessage(tr("failed to attach %1: %2").arg(name, mStream->errorString()),
+                                 3000);
+        return false;
+    }
+
+    mViewer->resetFrameStats();
+    setWindowTitle(mStream->name());
+    return true;
+#else
+    statusBar()->showMessage(tr("shared memory streams are not supported"), 3000);
+    Q_UNUSED(name)
+    return false;
+#endif
+}
+
+void MainWindow::detachStream() {
+#ifdef Q_OS_UNIX
+    if (mStream) {
+        mStream->detach();
+    }
+#endif
+}
+
+bool MainWindow::setOpenGL(bool enable) {
+    if (!mViewer->setOpenGL(enable)) {
+        statusBar()->showMessage(tr("OpenGL is not available, painting in software"), 3000);
+        return false;
+    }
+
+    return true;
+}
+
+void MainWindow::onPrefetched(const QString &filepath, bool success) {
+    if (filepath != mWaitingFile) {
+        return;
+    }
+
+    mWaitingFile.clear();
+    auto image = mPrefetcher->cachedImage(filepath);
+    if (success && !image.isNull()) {
+        mViewer->setImage(image);
+    } else {
         mViewer->loadImage(filepath);
     }
 }
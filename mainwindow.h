@@ -5,6 +5,9 @@
 
 #include "imageviewer.h"
 
+class ImagePrefetcher;
+class ShmFrameSource;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -21,10 +24,24 @@ public:
 public slots:
     void openFile();
     void saveFile();
+    void openImage(const QString &filepath);
+    void nextImage();
+    void previousImage();
+    // live frames from a shared memory ring written by another process, unix only
+    bool attachStream(const QString &name);
+    void detachStream();
+    // paint through OpenGL, falls back to the raster engine where it is not available
+    bool setOpenGL(bool enable);
+
+private:
+    void onPrefetched(const QString &filepath, bool success);
 
 private:
-    Ui::MainWindow *mUi;
-    ImageViewer    *mViewer;
+    Ui::MainWindow  *mUi;
+    ImageViewer     *mViewer;
+    ImagePrefetcher *mPrefetcher;
+    QString          mWaitingFile; // shown as soon as its prefetch finishes
+    ShmFrameSource  *mStream = nullptr;
 
     const int mIconFontSize = 22;
 };
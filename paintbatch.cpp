@@ -0,0 +1,50 @@
+#include "paintbatch.h"
+
+bool PaintBatch::isEmpty() const {
+    return outlines.isEmpty() && polygons.isEmpty() && paths.isEmpty() && runs.isEmpty() &&
+           dots.isEmpty();
+}
+
+void PaintBatch::paint(QPainter *painter, const LabelCategory &category, double worldScale) const {
+    paint(painter, category.color(), category.lineWidth(), worldScale);
+}
+
+void PaintBatch::paint(QPainter *painter, const QColor &color, int lineWidth,
+                       double worldScale) const {
+    if (isEmpty()) {
+        return;
+    }
+
+    auto fill = color;
+    fill.setAlpha(50);
+
+    painter->save();
+    painter->setPen(QPen(color, abs(lineWidth) / worldScale));
+    if (!polygons.isEmpty() || !paths.isEmpty()) {
+        painter->setBrush(fill);
+        for (const auto &polygon : polygons) {
+            painter->drawPolygon(polygon);
+        }
+        for (const auto &path : paths) {
+            painter->drawPath(path);
+        }
+    }
+
+    if (!outlines.isEmpty()) {
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPath(outlines);
+    }
+
+    if (!runs.isEmpty()) {
+        painter->setPen(QPen(fill, runWidth));
+        painter->drawLines(runs);
+    }
+
+    if (!dots.isEmpty()) {
+        QPen pen(color, dotSize);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawPoints(dots.constData(), static_cast<int>(dots.size()));
+    }
+    painter->restore();
+}
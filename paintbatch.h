@@ -0,0 +1,27 @@
+#ifndef PAINTBATCH_H
+#define PAINTBATCH_H
+
+#include "labelcategory.h"
+
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QVector>
+
+// geometry of the labels of one category, drawn with one painter setup per style instead of a
+// save, pen and restore per label
+struct PaintBatch {
+    QPainterPath          outlines; // category pen, no brush
+    QVector<QPolygonF>    polygons; // category pen, translucent category brush
+    QVector<QPainterPath> paths;    // as polygons, odd even filled
+    QVector<QPointF>      runs;     // pairs of points, translucent pen of runWidth
+    double                runWidth = 1.;
+    QVector<QPointF>      dots;     // labels too small to be drawn, cosmetic pen of dotSize
+    double                dotSize = 2.;
+
+    bool isEmpty() const;
+    void paint(QPainter *painter, const LabelCategory &category, double worldScale) const;
+    // with a style copied from a category, for painting off the GUI thread
+    void paint(QPainter *painter, const QColor &color, int lineWidth, double worldScale) const;
+};
+
+#endif // PAINTBATCH_H
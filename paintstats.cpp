@@ -0,0 +1,102 @@
+#include "paintstats.h"
+
+#include <algorithm>
+
+void PaintStats::beginFrame() {
+    if (!mClock.isValid()) {
+        mClock.start();
+    }
+
+    const auto now = mClock.nsecsElapsed();
+    mCurrent       = Frame();
+    if (mFrameStart >= 0) {
+        mCurrent.interval = now - mFrameStart;
+    }
+    mFrameStart = now;
+    mStageStart = now;
+}
+
+void PaintStats::endStage(Stage stage) {
+    const auto now = mClock.nsecsElapsed();
+
+    mCurrent.stages[ static_cast<size_t>(stage) ] += now - mStageStart;
+    mStageStart                                    = now;
+}
+
+void PaintStats::endFrame() {
+    mCurrent.total = mClock.nsecsElapsed() - mFrameStart;
+
+    // the oldest frame of the window leaves the sums
+    auto &slot = mWindow[ static_cast<size_t>(mNext) ];
+    for (size_t i = 0; i < StageCount; i++) {
+        mSum.stages[ i ] += mCurrent.stages[ i ] - slot.stages[ i ];
+    }
+    for (size_t i = 0; i < CacheCount; i++) {
+        mSum.hits[ i ]   = mSum.hits[ i ] - slot.hits[ i ] + mCurrent.hits[ i ];
+        mSum.misses[ i ] = mSum.misses[ i ] - slot.misses[ i ] + mCurrent.misses[ i ];
+    }
+    mSum.total    += mCurrent.total - slot.total;
+    mSum.interval += mCurrent.interval - slot.interval;
+
+    slot   = mCurrent;
+    mNext  = (mNext + 1) % WindowSize;
+    mCount = std::min(mCount + 1, WindowSize);
+}
+
+void PaintStats::count(Cache cache, quint64 hits, quint64 misses) {
+    const auto i          = static_cast<size_t>(cache);
+    mCurrent.hits[ i ]   += hits;
+    mCurrent.misses[ i ] += misses;
+}
+
+double PaintStats::stageMs(Stage stage) const {
+    return mCount > 0 ? double(mSum.stages[ static_cast<size_t>(stage) ]) / mCount / 1e6 : 0.;
+}
+
+double PaintStats::frameMs() const {
+    return mCount > 0 ? double(mSum.total) / mCount / 1e6 : 0.;
+}
+
+double PaintStats::fps() const {
+    return mSum.interval > 0 ? mCount * 1e9 / double(mSum.interval) : 0.;
+}
+
+double PaintStats::hitRate(Cache cache) const {
+    const auto i       = static_cast<size_t>(cache);
+    const auto lookups = mSum.hits[ i ] + mSum.misses[ i ];
+    return lookups > 0 ? double(mSum.hits[ i ]) / double(lookups) : -1.;
+}
+
+int PaintStats::frames() const {
+    return mCount;
+}
+
+const char *PaintStats::name(Stage stage) {
+    switch (stage) {
+        case Background:
+            return "background";
+        case Image:
+            return "image";
+        case Labels:
+            return "labels";
+        case Editor:
+            return "editor";
+        case Overlay:
+            return "overlay";
+        case StageCount:
+            break;
+    }
+    return "";
+}
+
+const char *PaintStats::name(Cache cache) {
+    switch (cache) {
+        case Layers:
+            return "layers";
+        case Tiles:
+            return "tiles";
+        case CacheCount:
+            break;
+    }
+    return "";
+}
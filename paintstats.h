@@ -0,0 +1,57 @@
+#ifndef PAINTSTATS_H
+#define PAINTSTATS_H
+
+#include <QElapsedTimer>
+
+#include <array>
+
+// rolling paint timings over the last frames, split into the stages of a paint. a frame costs a
+// few clock reads and sums, so it is always collected and only drawn on demand.
+class PaintStats {
+public:
+    enum Stage { Background, Image, Labels, Editor, Overlay, StageCount };
+    enum Cache { Layers, Tiles, CacheCount };
+
+    void beginFrame();
+    // time since the previous stage ended, or since the frame began
+    void endStage(Stage stage);
+    void endFrame();
+    // lookups of a cache during the frame
+    void count(Cache cache, quint64 hits, quint64 misses);
+
+    // averages over the window in milliseconds
+    double stageMs(Stage stage) const;
+    double frameMs() const;
+    // painted frames per second, idle time between paints included
+    double fps() const;
+    // share of hits in the window, -1 without lookups
+    double hitRate(Cache cache) const;
+    int    frames() const;
+
+    static const char *name(Stage stage);
+    static const char *name(Cache cache);
+
+private:
+    struct Frame {
+        std::array<qint64, StageCount>  stages{};
+        qint64                          total    = 0;
+        qint64                          interval = 0; // since the previous frame began
+        std::array<quint64, CacheCount> hits{};
+        std::array<quint64, CacheCount> misses{};
+    };
+
+private:
+    static constexpr int WindowSize = 60;
+
+    std::array<Frame, WindowSize> mWindow{};
+    Frame                         mSum;
+    Frame                         mCurrent;
+    int                           mNext  = 0;
+    int                           mCount = 0;
+
+    QElapsedTimer mClock;
+    qint64        mFrameStart = -1; // nanoseconds
+    qint64        mStageStart = 0;
+};
+
+#endif // PAINTSTATS_H
@@ -0,0 +1,66 @@
+#include "scenerenderer.h"
+
+#include <QPainter>
+
+SceneRenderer::SceneRenderer(QObject *parent)
+    : QObject(parent) {
+    // one frame at a time, newer requests wait and replace each other
+    mPool.setMaxThreadCount(1);
+}
+
+SceneRenderer::~SceneRenderer() {
+    // a running frame posts to this object, wait for it before it goes away
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+void SceneRenderer::render(const Scene &scene, const QTransform &transform, const QSize &size,
+                           qreal ratio) {
+    const auto request = ++mRequest;
+    mLatest            = request;
+
+    mPool.start([ this, scene, transform, size, ratio, request ]() {
+        if (mLatest != request) {
+            return;
+        }
+
+        Frame frame;
+        frame.transform = transform;
+        frame.request   = request;
+        frame.image     = QImage(size * ratio, QImage::Format_ARGB32_Premultiplied);
+        frame.image.setDevicePixelRatio(ratio);
+        frame.image.fill(Qt::transparent);
+
+        {
+            QPainter painter(&frame.image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.setTransform(transform);
+            for (const auto &layer : scene.layers) {
+                layer.batch.paint(&painter, layer.color, layer.lineWidth, scene.worldScale);
+            }
+        }
+
+        QMetaObject::invokeMethod(
+            this, [ this, frame ]() { onRendered(frame); }, Qt::QueuedConnection);
+    });
+}
+
+const SceneRenderer::Frame &SceneRenderer::frame() const {
+    return mFrame;
+}
+
+void SceneRenderer::clear() {
+    mPool.clear();
+    mCleared = mRequest;
+    mFrame   = Frame();
+}
+
+void SceneRenderer::onRendered(const Frame &frame) {
+    // a finished frame is still newer than the shown one while the view keeps moving
+    if (frame.request <= mCleared || frame.request <= mFrame.request) {
+        return;
+    }
+
+    mFrame = frame;
+    emit frameReady();
+}
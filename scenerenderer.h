@@ -0,0 +1,63 @@
+#ifndef SCENERENDERER_H
+#define SCENERENDERER_H
+
+#include "paintbatch.h"
+
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+#include <QTransform>
+#include <QVector>
+
+#include <atomic>
+
+// labels composed into an image on a worker thread, the widget only blits the newest frame.
+// the labels are handed over as a snapshot of value types, batched geometry and the style of
+// each category, so the GUI thread keeps editing them meanwhile. a request replaced before the
+// worker got to it is dropped.
+class SceneRenderer : public QObject {
+    Q_OBJECT
+public:
+    struct Layer {
+        PaintBatch batch;
+        QColor     color;
+        int        lineWidth = 2;
+    };
+
+    // labels at one world scale, line widths and detail depend on it
+    struct Scene {
+        QVector<Layer> layers;
+        double         worldScale = 1.;
+    };
+
+    struct Frame {
+        QImage     image;     // widget sized, device pixel ratio set
+        QTransform transform; // image to widget transform it was composed at
+        quint64    request = 0;
+    };
+
+    explicit SceneRenderer(QObject *parent = nullptr);
+    ~SceneRenderer() override;
+
+    // composes `scene` at `transform` on the worker, `size` in widget pixels
+    void render(const Scene &scene, const QTransform &transform, const QSize &size, qreal ratio);
+    // newest finished frame, null before the first one
+    const Frame &frame() const;
+    // frames of the requests so far are dropped
+    void clear();
+
+signals:
+    void frameReady();
+
+private:
+    void onRendered(const Frame &frame);
+
+private:
+    QThreadPool          mPool;
+    std::atomic<quint64> mLatest{0}; // read by the worker to drop superseded requests
+    quint64              mRequest = 0;
+    quint64              mCleared = 0; // requests up to it are dropped
+    Frame                mFrame;
+};
+
+#endif // SCENERENDERER_H
@@ -0,0 +1,91 @@
+#ifndef SHMFRAMES_H
+#define SHMFRAMES_H
+
+// layout of the shared memory frame ring written by an external producer, no Qt so producers
+// can include it as is.
+//
+// | Header | Slot[slotCount] | padding to dataAlign | slotCount * slotSize pixel bytes |
+//
+// a producer writes frame n (starting at 1) into a slot nobody reads:
+//   slot.seq = 0, then slot.readers must be 0, otherwise restore slot.seq and try another slot
+//   pixels and geometry, slot.seq = n, header.writeSeq = n
+// a reader holds the slot with the highest seq:
+//   slot.readers++, then slot.seq must still be the seq it picked, otherwise readers-- and retry
+//   pixels stay valid until readers--
+
+#include <atomic>
+#include <cstdint>
+
+namespace shmframes {
+
+constexpr uint32_t kMagic     = 0x4d524653; // "SFRM"
+constexpr uint32_t kVersion   = 1;
+constexpr uint64_t kDataAlign = 4096;
+
+enum PixelFormat : uint32_t {
+    Gray8    = 1,
+    Gray16   = 2, // native endian
+    RGB888   = 3, // r,g,b bytes
+    BGRA8888 = 4, // b,g,r,a bytes, premultiplied. 0xAARRGGBB words on little endian
+};
+
+struct Slot {
+    std::atomic<uint64_t> seq;     // frame number, 0 while written
+    std::atomic<uint32_t> readers; // holds of readers on the pixels
+    uint32_t              width;
+    uint32_t              height;
+    uint32_t              stride; // bytes per row
+    uint32_t              format; // PixelFormat
+    uint32_t              reserved;
+};
+
+struct Header {
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              slotCount;
+    uint32_t              reserved;
+    uint64_t              slotSize; // pixel bytes per slot
+    std::atomic<uint64_t> writeSeq; // newest complete frame
+};
+
+// shared between processes, only lock free atomics work there
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64bit atomics are not lock free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "32bit atomics are not lock free");
+
+inline uint64_t dataOffset(uint32_t slotCount) {
+    const uint64_t end = sizeof(Header) + uint64_t(slotCount) * sizeof(Slot);
+    return (end + kDataAlign - 1) / kDataAlign * kDataAlign;
+}
+
+inline uint64_t totalSize(uint32_t slotCount, uint64_t slotSize) {
+    return dataOffset(slotCount) + uint64_t(slotCount) * slotSize;
+}
+
+// not `slots`, Qt defines it as a keyword
+inline Slot *slotArray(Header *header) {
+    return reinterpret_cast<Slot *>(header + 1);
+}
+
+inline unsigned char *slotData(Header *header, uint32_t index) {
+    return reinterpret_cast<unsigned char *>(header) + dataOffset(header->slotCount) +
+           uint64_t(index) * header->slotSize;
+}
+
+inline uint32_t bytesPerPixel(uint32_t format) {
+    switch (format) {
+        case Gray8:
+            return 1;
+        case Gray16:
+            return 2;
+        case RGB888:
+            return 3;
+        case BGRA8888:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+} // namespace shmframes
+
+#endif // SHMFRAMES_H
@@ -0,0 +1,194 @@
+#include "shmframesource.h"
+
+#include <QSysInfo>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct ShmMapping {
+    void  *address = nullptr;
+    size_t size    = 0;
+
+    ~ShmMapping() {
+        if (address) {
+            munmap(address, size);
+        }
+    }
+};
+
+namespace {
+// hold on a slot, released by the image cleanup
+struct SlotHold {
+    QSharedPointer<ShmMapping> mapping;
+    shmframes::Slot           *slot;
+};
+
+void releaseSlot(void *info) {
+    auto *hold = static_cast<SlotHold *>(info);
+    hold->slot->readers.fetch_sub(1);
+    delete hold;
+}
+
+QImage::Format imageFormat(quint32 format) {
+    switch (format) {
+        case shmframes::Gray8:
+            return QImage::Format_Grayscale8;
+        case shmframes::Gray16:
+            return QImage::Format_Grayscale16;
+        case shmframes::RGB888:
+            return QImage::Format_RGB888;
+        case shmframes::BGRA8888:
+            // the byte order of QImage's 32bit words
+            return QSysInfo::ByteOrder == QSysInfo::LittleEndian
+                       ? QImage::Format_ARGB32_Premultiplied
+                       : QImage::Format_Invalid;
+        default:
+            return QImage::Format_Invalid;
+    }
+}
+} // namespace
+
+ShmFrameSource::ShmFrameSource(QObject *parent)
+    : QObject(parent) {
+    mTimer.setTimerType(Qt::PreciseTimer);
+    mTimer.setInterval(2);
+    connect(&mTimer, &QTimer::timeout, this, &ShmFrameSource::poll);
+}
+
+ShmFrameSource::~ShmFrameSource() {
+    detach();
+}
+
+bool ShmFrameSource::attach(const QString &name) {
+    detach();
+
+    mName           = name.startsWith('/') ? name : '/' + name;
+    const auto path = mName.toLocal8Bit();
+
+    const int fd = shm_open(path.constData(), O_RDWR, 0);
+    if (fd < 0) {
+        mError = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || info.st_size < qint64(sizeof(shmframes::Header))) {
+        ::close(fd);
+        mError = tr("not a frame ring");
+        return false;
+    }
+
+    QSharedPointer<ShmMapping> mapping(new ShmMapping);
+    mapping->size    = static_cast<size_t>(info.st_size);
+    mapping->address = mmap(nullptr, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping->address == MAP_FAILED) {
+        mapping->address = nullptr;
+        mError           = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+
+    auto *header = static_cast<shmframes::Header *>(mapping->address);
+    if (header->magic != shmframes::kMagic || header->version != shmframes::kVersion ||
+        header->slotCount == 0 ||
+        shmframes::totalSize(header->slotCount, header->slotSize) > mapping->size) {
+        mError = tr("not a frame ring");
+        return false;
+    }
+
+    mMapping = mapping;
+    mHeader  = header;
+    mLastSeq = 0;
+    mError.clear();
+    mTimer.start();
+    return true;
+}
+
+void ShmFrameSource::detach() {
+    mTimer.stop();
+
+    // held frames keep their own reference on the mapping
+    mHeader = nullptr;
+    mMapping.reset();
+}
+
+bool ShmFrameSource::isAttached() const {
+    return mHeader != nullptr;
+}
+
+QString ShmFrameSource::name() const {
+    return mName;
+}
+
+QString ShmFrameSource::errorString() const {
+    return mError;
+}
+
+void ShmFrameSource::setInterval(int msec) {
+    mTimer.setInterval(msec);
+}
+
+int ShmFrameSource::interval() const {
+    return mTimer.interval();
+}
+
+void ShmFrameSource::poll() {
+    if (!mHeader || mHeader->writeSeq.load(std::memory_order_acquire) == mLastSeq) {
+        return;
+    }
+
+    // the producer may overwrite the newest slot while it is picked, try again a few times
+    auto *slotArray = shmframes::slotArray(mHeader);
+    for (quint32 attempt = 0; attempt < mHeader->slotCount; attempt++) {
+        quint32 index = 0;
+        quint64 seq   = 0;
+        for (quint32 i = 0; i < mHeader->slotCount; i++) {
+            const auto current = slotArray[ i ].seq.load(std::memory_order_acquire);
+            if (current > seq) {
+                seq   = current;
+                index = i;
+            }
+        }
+
+        if (seq <= mLastSeq) {
+            return;
+        }
+
+        slotArray[ index ].readers.fetch_add(1);
+        if (slotArray[ index ].seq.load() != seq) {
+            slotArray[ index ].readers.fetch_sub(1);
+            continue;
+        }
+
+        mLastSeq   = seq;
+        auto frame = holdFrame(index);
+        if (!frame.isNull()) {
+            emit frameReady(frame);
+        }
+        return;
+    }
+}
+
+QImage ShmFrameSource::holdFrame(quint32 index) {
+    auto      &slot   = shmframes::slotArray(mHeader)[ index ];
+    const auto format = imageFormat(slot.format);
+    const auto bpp    = shmframes::bytesPerPixel(slot.format);
+
+    // geometry is not trusted, it has to fit into the slot
+    if (format == QImage::Format_Invalid || slot.width == 0 || slot.height == 0 ||
+        quint64(slot.width) * bpp > slot.stride || slot.stride > quint32(INT_MAX) ||
+        quint64(slot.stride) * slot.height > mHeader->slotSize) {
+        slot.readers.fetch_sub(1);
+        return {};
+    }
+
+    auto *hold = new SlotHold{mMapping, &slot};
+    return QImage(shmframes::slotData(mHeader, index), static_cast<int>(slot.width),
+                  static_cast<int>(slot.height), static_cast<int>(slot.stride), format,
+                  releaseSlot, hold);
+}
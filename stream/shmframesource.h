@@ -0,0 +1,47 @@
+#ifndef SHMFRAMESOURCE_H
+#define SHMFRAMESOURCE_H
+
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include "shmframes.h"
+
+struct ShmMapping;
+
+// reader of a shared memory frame ring (see shmframes.h). frames point into the shared
+// memory, the slot stays held until the last copy of the image goes away.
+class ShmFrameSource : public QObject {
+    Q_OBJECT
+public:
+    explicit ShmFrameSource(QObject *parent = nullptr);
+    ~ShmFrameSource() override;
+
+    bool    attach(const QString &name);
+    void    detach();
+    bool    isAttached() const;
+    QString name() const;
+    QString errorString() const;
+
+    // polling period of the write sequence
+    void setInterval(int msec);
+    int  interval() const;
+
+signals:
+    void frameReady(const QImage &frame);
+
+private:
+    void   poll();
+    QImage holdFrame(quint32 index);
+
+private:
+    QSharedPointer<ShmMapping> mMapping;
+    shmframes::Header         *mHeader  = nullptr;
+    quint64                    mLastSeq = 0;
+    QString                    mName;
+    QString                    mError;
+    QTimer                     mTimer;
+};
+
+#endif // SHMFRAMESOURCE_H
@@ -0,0 +1,202 @@
+// the plain, sse2 and avx geometry kernels against brute force loops on random points. they
+// have to agree exactly, ties going to the lowest index. points lie on a coarse grid so that
+// ties, repeated points and degenerate segments are common
+#include "utilssimd.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if defined(VIEWER_AVX) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+struct Kernels {
+    const char *name;
+    int (*nearestPoint)(const double *, int, double, double, double *);
+    int (*nearestSegment)(const double *, int, bool, double, double, double *);
+    int (*pointsWithin)(const double *, int, double, double, double, int *, int);
+    int (*winding)(const double *, int, double, double);
+};
+
+template <class S>
+Kernels kernelsFor(const char *name) {
+    return {name, &simd::nearestPoint<S>, &simd::nearestSegment<S>, &simd::pointsWithin<S>,
+            &simd::winding<S>};
+}
+
+#ifdef VIEWER_AVX
+bool cpuHasAvx() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[ 4 ] = {};
+    __cpuid(info, 1);
+    const bool avx = (info[ 2 ] & (1 << 28)) && (info[ 2 ] & (1 << 27));
+    return avx && (_xgetbv(0) & 6) == 6;
+#else
+    return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+#endif
+
+// the references below do the arithmetic of the kernels in the same order, one item at a time
+
+double pointDistance2(const double *p, double px, double py) {
+    const double dx = p[ 0 ] - px;
+    const double dy = p[ 1 ] - py;
+    return dx * dx + dy * dy;
+}
+
+double segmentDistance2(const double *a, const double *b, double px, double py) {
+    const double abx = b[ 0 ] - a[ 0 ];
+    const double aby = b[ 1 ] - a[ 1 ];
+    const double apx = px - a[ 0 ];
+    const double apy = py - a[ 1 ];
+    const double ab2 = abx * abx + aby * aby;
+    const double dot = apx * abx + apy * aby;
+    double       t   = 0.;
+    if (ab2 > 0.) {
+        t = dot / ab2;
+        t = t < 1. ? t : 1.;
+        t = t > 0. ? t : 0.;
+    }
+    const double dx = apx - abx * t;
+    const double dy = apy - aby * t;
+    return dx * dx + dy * dy;
+}
+
+int nearestPoint(const double *xy, int count, double px, double py, double *distance2) {
+    int    found  = -1;
+    double found2 = HUGE_VAL;
+    for (int i = 0; i < count; i++) {
+        const double d2 = pointDistance2(xy + 2 * i, px, py);
+        if (d2 < found2) {
+            found  = i;
+            found2 = d2;
+        }
+    }
+    *distance2 = found2;
+    return found;
+}
+
+int nearestSegment(const double *xy, int count, bool closed, double px, double py,
+                   double *distance2) {
+    int       found  = -1;
+    double    found2 = HUGE_VAL;
+    const int edges  = closed && count > 1 ? count : count - 1;
+    for (int i = 0; i < edges; i++) {
+        const double d2 = segmentDistance2(xy + 2 * i, xy + 2 * ((i + 1) % count), px, py);
+        if (d2 < found2) {
+            found  = i;
+            found2 = d2;
+        }
+    }
+    *distance2 = found2;
+    return found;
+}
+
+int pointsWithin(const double *xy, int count, double px, double py, double radius2, int *indices,
+                 int limit) {
+    int found = 0;
+    for (int i = 0; i < count && found < limit; i++) {
+        if (pointDistance2(xy + 2 * i, px, py) < radius2) {
+            indices[ found++ ] = i;
+        }
+    }
+    return found;
+}
+
+int winding(const double *xy, int count, double px, double py) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        const double *a = xy + 2 * i;
+        const double *b = xy + 2 * ((i + 1) % count);
+        if ((a[ 1 ] <= py) != (b[ 1 ] <= py)) {
+            const double x = a[ 0 ] + (py - a[ 1 ]) * (b[ 0 ] - a[ 0 ]) / (b[ 1 ] - a[ 1 ]);
+            if (x > px) {
+                result += b[ 1 ] > a[ 1 ] ? 1 : -1;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    std::vector<Kernels> variants{kernelsFor<simd::Scalar>("plain")};
+#ifdef UTILS_SSE2
+    variants.push_back(kernelsFor<simd::Sse2>("sse2"));
+#endif
+#ifdef VIEWER_AVX
+    if (cpuHasAvx()) {
+        variants.push_back({"avx", &simd::avx::nearestPoint, &simd::avx::nearestSegment,
+                            &simd::avx::pointsWithin, &simd::avx::winding});
+    }
+#endif
+
+    std::mt19937                       random(1234);
+    std::uniform_int_distribution<int> coordinate(-8, 8);
+    std::uniform_int_distribution<int> sizes(0, 40);
+
+    int failures = 0;
+    int runs     = 0;
+    for (int round = 0; round < 20000; round++) {
+        const int           count = sizes(random);
+        std::vector<double> xy(2 * static_cast<size_t>(count));
+        for (auto &value : xy) {
+            value = coordinate(random) * 0.5;
+        }
+        const double px      = coordinate(random) * 0.25;
+        const double py      = coordinate(random) * 0.25;
+        const double radius2 = coordinate(random) + 8.;
+        const int    limit   = round % 3 == 0 ? count / 2 : count;
+        const bool   closed  = round % 2 == 0;
+
+        double     point2 = 0.;
+        double     edge2  = 0.;
+        const auto point  = nearestPoint(xy.data(), count, px, py, &point2);
+        const auto edge   = nearestSegment(xy.data(), count, closed, px, py, &edge2);
+        const auto turns  = winding(xy.data(), count, px, py);
+
+        std::vector<int> within(static_cast<size_t>(count));
+        within.resize(static_cast<size_t>(
+            pointsWithin(xy.data(), count, px, py, radius2, within.data(), limit)));
+
+        for (const auto &kernels : variants) {
+            double     kernelPoint2 = 0.;
+            double     kernelEdge2  = 0.;
+            const auto kernelPoint  = kernels.nearestPoint(xy.data(), count, px, py, &kernelPoint2);
+            const auto kernelEdge =
+                kernels.nearestSegment(xy.data(), count, closed, px, py, &kernelEdge2);
+            const auto kernelTurns = kernels.winding(xy.data(), count, px, py);
+
+            std::vector<int> kernelWithin(static_cast<size_t>(count));
+            kernelWithin.resize(static_cast<size_t>(kernels.pointsWithin(
+                xy.data(), count, px, py, radius2, kernelWithin.data(), limit)));
+
+            const bool same = kernelPoint == point && (point < 0 || kernelPoint2 == point2) &&
+                              kernelEdge == edge && (edge < 0 || kernelEdge2 == edge2) &&
+                              kernelTurns == turns && kernelWithin == within;
+            if (!same) {
+                if (failures < 10) {
+                    std::fprintf(stderr,
+                                 "%s round %d, %d points: point %d/%d, segment %d/%d, winding "
+                                 "%d/%d, within %zu/%zu\n",
+                                 kernels.name, round, count, kernelPoint, point, kernelEdge, edge,
+                                 kernelTurns, turns, kernelWithin.size(), within.size());
+                }
+                failures++;
+            }
+            runs++;
+        }
+    }
+
+    for (const auto &kernels : variants) {
+        std::printf("%s ", kernels.name);
+    }
+    std::printf("kernels: %d runs, %d failed\n", runs, failures);
+    return failures == 0 ? 0 : 1;
+}
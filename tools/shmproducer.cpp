@@ -0,0 +1,173 @@
+// test producer for the viewer's shared memory frame ring, writes a moving pattern.
+//
+//   shmproducer [name] [width] [height] [fps] [gray8|gray16|rgb|bgra] [slots]
+//   viewer --shm name
+
+#include "stream/shmframes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+volatile std::sig_atomic_t running = 1;
+
+void stop(int) {
+    running = 0;
+}
+
+uint32_t parseFormat(const std::string &name) {
+    if (name == "gray8") {
+        return shmframes::Gray8;
+    }
+    if (name == "gray16") {
+        return shmframes::Gray16;
+    }
+    if (name == "rgb") {
+        return shmframes::RGB888;
+    }
+    if (name == "bgra") {
+        return shmframes::BGRA8888;
+    }
+    return 0;
+}
+
+void drawPattern(unsigned char *data, uint32_t width, uint32_t height, uint32_t stride,
+                 uint32_t format, uint64_t frame) {
+    const auto shift = static_cast<uint32_t>(frame * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        auto *row = data + uint64_t(y) * stride;
+        for (uint32_t x = 0; x < width; x++) {
+            const auto value = static_cast<uint8_t>((x + shift) ^ y);
+            switch (format) {
+                case shmframes::Gray8:
+                    row[ x ] = value;
+                    break;
+                case shmframes::Gray16: {
+                    const auto sample =
+                        static_cast<uint16_t>(((x + shift) * 4096u / width) & 0xfff);
+                    std::memcpy(row + x * 2, &sample, 2);
+                    break;
+                }
+                case shmframes::RGB888:
+                    row[ x * 3 + 0 ] = value;
+                    row[ x * 3 + 1 ] = static_cast<uint8_t>(y + shift);
+                    row[ x * 3 + 2 ] = static_cast<uint8_t>(x);
+                    break;
+                default:
+                    row[ x * 4 + 0 ] = static_cast<uint8_t>(x);
+                    row[ x * 4 + 1 ] = static_cast<uint8_t>(y + shift);
+                    row[ x * 4 + 2 ] = value;
+                    row[ x * 4 + 3 ] = 0xff;
+                    break;
+            }
+        }
+    }
+}
+
+// slot nobody reads, claimed by zeroing its seq, -1 if all are held
+int claimSlot(shmframes::Header *header, uint64_t frame) {
+    auto *slotArray = shmframes::slotArray(header);
+    for (uint32_t i = 0; i < header->slotCount; i++) {
+        auto      &slot = slotArray[ (frame + i) % header->slotCount ];
+        const auto old  = slot.seq.exchange(0);
+        if (slot.readers.load() == 0) {
+            return static_cast<int>((frame + i) % header->slotCount);
+        }
+        slot.seq.store(old);
+    }
+    return -1;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const std::string name   = argc > 1 ? argv[ 1 ] : "/viewer_frames";
+    const auto        width  = static_cast<uint32_t>(argc > 2 ? std::atoi(argv[ 2 ]) : 1920);
+    const auto        height = static_cast<uint32_t>(argc > 3 ? std::atoi(argv[ 3 ]) : 1080);
+    const int         fps    = argc > 4 ? std::max(1, std::atoi(argv[ 4 ])) : 60;
+    const auto        format = parseFormat(argc > 5 ? argv[ 5 ] : "bgra");
+    const auto count = static_cast<uint32_t>(argc > 6 ? std::max(3, std::atoi(argv[ 6 ])) : 4);
+    if (width == 0 || height == 0 || format == 0) {
+        std::fprintf(stderr,
+                     "usage: %s [name] [width] [height] [fps] [gray8|gray16|rgb|bgra] [slots]\n",
+                     argv[ 0 ]);
+        return 1;
+    }
+
+    const auto     path     = name[ 0 ] == '/' ? name : "/" + name;
+    const uint32_t stride   = (width * shmframes::bytesPerPixel(format) + 3) / 4 * 4;
+    const uint64_t slotSize = uint64_t(stride) * height;
+    const uint64_t size     = shmframes::totalSize(count, slotSize);
+
+    const int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::perror("shm_open");
+        return 1;
+    }
+
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        std::perror("mmap");
+        shm_unlink(path.c_str());
+        return 1;
+    }
+
+    // the header is written last, readers check the magic
+    std::memset(address, 0, shmframes::dataOffset(count));
+    auto *header      = static_cast<shmframes::Header *>(address);
+    header->version   = shmframes::kVersion;
+    header->slotCount = count;
+    header->slotSize  = slotSize;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shmframes::kMagic;
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::printf("%s: %ux%u at %d fps in %u slots, ctrl+c to stop\n", path.c_str(), width, height,
+                fps, count);
+
+    const auto period  = std::chrono::nanoseconds(1000000000 / fps);
+    auto       next    = std::chrono::steady_clock::now();
+    uint64_t   frame   = 1;
+    uint64_t   skipped = 0;
+    while (running) {
+        const int index = claimSlot(header, frame);
+        if (index < 0) {
+            skipped++;
+        } else {
+            auto &slot  = shmframes::slotArray(header)[ index ];
+            slot.width  = width;
+            slot.height = height;
+            slot.stride = stride;
+            slot.format = format;
+            drawPattern(shmframes::slotData(header, static_cast<uint32_t>(index)), width, height,
+                        stride, format, frame);
+            slot.seq.store(frame, std::memory_order_release);
+            header->writeSeq.store(frame, std::memory_order_release);
+        }
+
+        if (frame % static_cast<uint64_t>(fps) == 0) {
+            std::printf("\rframe %llu, %llu skipped", static_cast<unsigned long long>(frame),
+                        static_cast<unsigned long long>(skipped));
+            std::fflush(stdout);
+        }
+
+        frame++;
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    std::printf("\n");
+    munmap(address, size);
+    shm_unlink(path.c_str());
+    return 0;
+}
@@ -1,6 +1,16 @@
 #include "utils.h"
+#include "utilssimd.h"
 
+#include <QPair>
+
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
+
+#if defined(VIEWER_AVX) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
 
 double distance(const QPointF &p1, const QPointF &p2) {
     auto delta = p1 - p2;
@@ -31,3 +41,360 @@ double distance(const QPointF &point, const QLineF &line) {
 
     return QLineF(point, QPointF(x, y)).length();
 }
+
+namespace {
+
+// the widest kernels the cpu runs, picked on first use
+struct Kernels {
+    int (*nearestPoint)(const double *, int, double, double, double *);
+    int (*nearestSegment)(const double *, int, bool, double, double, double *);
+    int (*pointsWithin)(const double *, int, double, double, double, int *, int);
+    int (*winding)(const double *, int, double, double);
+};
+
+template <class S>
+Kernels kernelsFor() {
+    return {&simd::nearestPoint<S>, &simd::nearestSegment<S>, &simd::pointsWithin<S>,
+            &simd::winding<S>};
+}
+
+#ifdef VIEWER_AVX
+bool cpuHasAvx() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    // avx, and the os saving its registers on a context switch
+    int info[ 4 ] = {};
+    __cpuid(info, 1);
+    const bool avx = (info[ 2 ] & (1 << 28)) && (info[ 2 ] & (1 << 27));
+    return avx && (_xgetbv(0) & 6) == 6;
+#else
+    return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+#endif
+
+const Kernels &kernels() {
+    static const Kernels widest = [] {
+#ifdef VIEWER_AVX
+        if (cpuHasAvx()) {
+            return Kernels{&simd::avx::nearestPoint, &simd::avx::nearestSegment,
+                           &simd::avx::pointsWithin, &simd::avx::winding};
+        }
+#endif
+#ifdef UTILS_SSE2
+        return kernelsFor<simd::Sse2>();
+#else
+        return kernelsFor<simd::Scalar>();
+#endif
+    }();
+    return widest;
+}
+
+// the kernels read interleaved doubles, points are only copied when qreal is float
+const double *coordinates(const QPointF *points, int count, QVector<double> &buffer) {
+    if constexpr (std::is_same_v<qreal, double>) {
+        return reinterpret_cast<const double *>(points);
+    }
+
+    buffer.resize(2 * count);
+    for (int i = 0; i < count; i++) {
+        buffer[ 2 * i ]     = points[ i ].x();
+        buffer[ 2 * i + 1 ] = points[ i ].y();
+    }
+    return buffer.constData();
+}
+
+} // namespace
+
+int nearestPoint(const QPointF *points, int count, const QPointF &pos, double *distance2) {
+    QVector<double> buffer;
+    const auto     *xy = coordinates(points, count, buffer);
+    return kernels().nearestPoint(xy, count, pos.x(), pos.y(), distance2);
+}
+
+int nearestSegment(const QPointF *points, int count, bool closed, const QPointF &pos,
+                   double *distance2) {
+    QVector<double> buffer;
+    const auto     *xy = coordinates(points, count, buffer);
+    return kernels().nearestSegment(xy, count, closed, pos.x(), pos.y(), distance2);
+}
+
+QVector<int> pointsWithin(const QPointF *points, int count, const QPointF &pos, double radius,
+                          int limit) {
+    if (count <= 0 || limit <= 0 || !(radius > 0.)) {
+        return {};
+    }
+
+    QVector<double> buffer;
+    const auto     *xy = coordinates(points, count, buffer);
+    QVector<int>    indices(std::min(count, limit));
+    indices.resize(kernels().pointsWithin(xy, count, pos.x(), pos.y(), radius * radius,
+                                          indices.data(), limit));
+    return indices;
+}
+
+int windingNumber(const QPointF *points, int count, const QPointF &pos) {
+    QVector<double> buffer;
+    const auto     *xy = coordinates(points, count, buffer);
+    return kernels().winding(xy, count, pos.x(), pos.y());
+}
+
+QStringList toStrings(const QVector<double> &values) {
+    QStringList result;
+    result.reserve(values.size());
+    for (auto value : values) {
+        result.append(QString::number(value, 'g', 17));
+    }
+
+    return result;
+}
+
+QVector<double> toNumbers(const QStringList &source) {
+    QVector<double> result;
+    result.reserve(source.size());
+    for (const auto &item : source) {
+        bool ok    = false;
+        auto value = item.toDouble(&ok);
+        if (!ok) {
+            return {};
+        }
+        result.append(value);
+    }
+
+    return result;
+}
+
+QPolygonF simplify(const QPolygonF &polygon, double tolerance) {
+    const auto count = static_cast<int>(polygon.size());
+    if (count < 3) {
+        return polygon;
+    }
+
+    QVector<bool> keep(count, false);
+    keep[ 0 ]         = true;
+    keep[ count - 1 ] = true;
+
+    // ranges still to split, iterative so huge polygons can not overflow the stack
+    QVector<QPair<int, int>> ranges{{0, count - 1}};
+    const double             tolerance2 = tolerance * tolerance;
+    while (!ranges.isEmpty()) {
+        const auto range = ranges.takeLast();
+        const auto a     = polygon[ range.first ];
+        const auto ab    = polygon[ range.second ] - a;
+        const auto ab2   = QPointF::dotProduct(ab, ab);
+
+        int    farthest  = -1;
+        double distance2 = tolerance2;
+        for (int i = range.first + 1; i < range.second; i++) {
+            const auto ap = polygon[ i ] - a;
+            // squared distance to the segment, to the end point for a degenerate one
+            const auto t  = ab2 > 0. ? std::clamp(QPointF::dotProduct(ap, ab) / ab2, 0., 1.) : 0.;
+            const auto d  = ap - ab * t;
+            const auto d2 = QPointF::dotProduct(d, d);
+            if (d2 > distance2) {
+                distance2 = d2;
+                farthest  = i;
+            }
+        }
+
+        if (farthest >= 0) {
+            keep[ farthest ] = true;
+            ranges.append({range.first, farthest});
+            ranges.append({farthest, range.second});
+        }
+    }
+
+    QPolygonF result;
+    for (int i = 0; i < count; i++) {
+        if (keep[ i ]) {
+            result.append(polygon[ i ]);
+        }
+    }
+
+    return result;
+}
+
+const QPolygonF &PolygonLod::polygon(const QPolygonF &source, double worldScale) {
+    // shared data compares without looking at the points
+    if (source != mSource) {
+        mSource = source;
+        mLevels.clear();
+    }
+
+    // level k has a tolerance of 2^k image pixels
+    const double tolerance = 0.5 / worldScale;
+    if (tolerance < 1.) {
+        return mSource;
+    }
+
+    const int level = std::min(static_cast<int>(std::log2(tolerance)), mLevelCount - 1);
+    if (mLevels.isEmpty()) {
+        mLevels.resize(mLevelCount);
+    }
+    if (mLevels[ level ].isEmpty()) {
+        mLevels[ level ] = simplify(mSource, std::ldexp(1., level));
+    }
+
+    return mLevels[ level ];
+}
+
+void PolygonIndex::build(const QPolygonF &polygon) {
+    clear();
+    if (polygon.size() < mMinVertices) {
+        return;
+    }
+
+    const auto count = static_cast<int>(polygon.size());
+    mBox             = polygon.boundingRect();
+    mValid           = true;
+
+    // a few edges per band, a few vertices per cell
+    const int bands = std::clamp(count / 4, 1, 1024);
+    mBandTop        = mBox.top();
+    mBandHeight     = std::max(mBox.height() / bands, 1e-6);
+    mBands.resize(bands);
+    for (int i = 0; i < count; i++) {
+        addEdge(polygon, i);
+    }
+
+    mCellSize = std::max(std::max(mBox.width(), mBox.height()) / std::sqrt(double(count)), 1e-6);
+    for (int i = 0; i < count; i++) {
+        mCells[ cellOf(polygon[ i ]) ].append(i);
+    }
+}
+
+void PolygonIndex::clear() {
+    mValid  = false;
+    mBox    = QRectF();
+    mOffset = QPointF();
+    mBands.clear();
+    mCells.clear();
+}
+
+bool PolygonIndex::isValid() const {
+    return mValid;
+}
+
+void PolygonIndex::moveVertex(const QPolygonF &polygon, int index, const QPointF &from) {
+    if (!mValid) {
+        return;
+    }
+
+    // the two edges at the vertex and its cell
+    const auto count    = static_cast<int>(polygon.size());
+    const int  previous = (index + count - 1) % count;
+    const int  next     = (index + 1) % count;
+    removeEdge(previous, polygon[ previous ], from);
+    removeEdge(index, from, polygon[ next ]);
+    addEdge(polygon, previous);
+    addEdge(polygon, index);
+
+    auto it = mCells.find(cellOf(from - mOffset));
+    if (it != mCells.end()) {
+        it->removeOne(index);
+    }
+    mCells[ cellOf(polygon[ index ] - mOffset) ].append(index);
+
+    const auto &vertex = polygon[ index ];
+    mBox.setCoords(std::min(mBox.left(), vertex.x()), std::min(mBox.top(), vertex.y()),
+                   std::max(mBox.right(), vertex.x()), std::max(mBox.bottom(), vertex.y()));
+}
+
+void PolygonIndex::translate(const QPointF &delta) {
+    if (mValid) {
+        mOffset += delta;
+        mBox.translate(delta);
+    }
+}
+
+bool PolygonIndex::contains(const QPolygonF &polygon, const QPointF &pos) const {
+    if (!mValid) {
+        return windingNumber(polygon.constData(), static_cast<int>(polygon.size()), pos) != 0;
+    }
+    if (!mBox.contains(pos)) {
+        return false;
+    }
+
+    // winding number over the edges crossing the row of `pos`
+    const auto p       = pos - mOffset;
+    const auto count   = static_cast<int>(polygon.size());
+    int        winding = 0;
+    for (const int i : mBands[ bandOf(p.y()) ]) {
+        const auto a = polygon[ i ] - mOffset;
+        const auto b = polygon[ (i + 1) % count ] - mOffset;
+        if ((a.y() <= p.y()) == (b.y() <= p.y())) {
+            continue;
+        }
+
+        const double x = a.x() + (p.y() - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+        if (x > p.x()) {
+            winding += b.y() > a.y() ? 1 : -1;
+        }
+    }
+
+    return winding != 0;
+}
+
+int PolygonIndex::vertexAt(const QPolygonF &polygon, const QPointF &pos, double radius) const {
+    const auto nearest = [ & ](int i) { return distance2_sq(polygon[ i ], pos) < radius * radius; };
+    if (mValid && !mBox.adjusted(-radius, -radius, radius, radius).contains(pos)) {
+        return -1;
+    }
+
+    // a radius over many cells, zoomed far out, scans all vertices
+    const auto p      = pos - mOffset;
+    const auto left   = std::floor((p.x() - radius) / mCellSize);
+    const auto right  = std::floor((p.x() + radius) / mCellSize);
+    const auto top    = std::floor((p.y() - radius) / mCellSize);
+    const auto bottom = std::floor((p.y() + radius) / mCellSize);
+    if (!mValid || (right - left + 1.) * (bottom - top + 1.) > mMaxCells) {
+        const auto found =
+            pointsWithin(polygon.constData(), static_cast<int>(polygon.size()), pos, radius, 1);
+        return found.isEmpty() ? -1 : found.first();
+    }
+
+    int found = -1;
+    for (auto y = static_cast<int>(top); y <= static_cast<int>(bottom); y++) {
+        for (auto x = static_cast<int>(left); x <= static_cast<int>(right); x++) {
+            const auto it = mCells.constFind((quint64(quint32(x)) << 32) | quint32(y));
+            if (it == mCells.constEnd()) {
+                continue;
+            }
+            for (const int i : *it) {
+                if ((found < 0 || i < found) && nearest(i)) {
+                    found = i;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+int PolygonIndex::bandOf(double y) const {
+    const auto band = static_cast<int>(std::floor((y - mBandTop) / mBandHeight));
+    return std::clamp(band, 0, static_cast<int>(mBands.size()) - 1);
+}
+
+quint64 PolygonIndex::cellOf(const QPointF &point) const {
+    const auto x = static_cast<int>(std::floor(point.x() / mCellSize));
+    const auto y = static_cast<int>(std::floor(point.y() / mCellSize));
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+void PolygonIndex::addEdge(const QPolygonF &polygon, int index) {
+    const auto a     = polygon[ index ] - mOffset;
+    const auto b     = polygon[ (index + 1) % polygon.size() ] - mOffset;
+    const int  first = bandOf(std::min(a.y(), b.y()));
+    const int  last  = bandOf(std::max(a.y(), b.y()));
+    for (int band = first; band <= last; band++) {
+        mBands[ band ].append(index);
+    }
+}
+
+void PolygonIndex::removeEdge(int index, const QPointF &p0, const QPointF &p1) {
+    const int first = bandOf(std::min(p0.y(), p1.y()) - mOffset.y());
+    const int last  = bandOf(std::max(p0.y(), p1.y()) - mOffset.y());
+    for (int band = first; band <= last; band++) {
+        mBands[ band ].removeOne(index);
+    }
+}
@@ -1,8 +1,14 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <QHash>
 #include <QLineF>
 #include <QPointF>
+#include <QPolygonF>
+#include <QStringList>
+#include <QVector>
+
+#include <limits>
 
 double distance(const QPointF &p1, const QPointF &p2);
 
@@ -12,4 +18,78 @@ double distance2_sq(const QPointF &p1, const QPointF &p2);
 
 double distance(const QPointF &point, const QLineF &line);
 
+// batched queries over `count` contiguous points, vectorised with sse2 or avx as the cpu allows.
+// distances are euclidean, results are the same as testing the points one by one
+
+// nearest point to `pos` and its squared distance, the lowest index on a tie. -1 if there is none
+int nearestPoint(const QPointF *points, int count, const QPointF &pos, double *distance2 = nullptr);
+// nearest segment, segment i goes from point i to i + 1 and if `closed` the last one back to 0
+int nearestSegment(const QPointF *points, int count, bool closed, const QPointF &pos,
+                   double *distance2 = nullptr);
+// ascending indices of the points closer than `radius`, the first `limit` of them
+QVector<int> pointsWithin(const QPointF *points, int count, const QPointF &pos, double radius,
+                          int limit = std::numeric_limits<int>::max());
+// edge crossings right of `pos` by direction, nonzero inside the polygon with the winding fill
+int windingNumber(const QPointF *points, int count, const QPointF &pos);
+
+// label serialization, numbers round trip exactly. empty result on any invalid number
+QStringList     toStrings(const QVector<double> &values);
+QVector<double> toNumbers(const QStringList &source);
+
+// douglas peucker, no point of the result is further than `tolerance` from the polygon
+QPolygonF simplify(const QPolygonF &polygon, double tolerance);
+
+// simplified versions of a polygon for drawing it zoomed out, with tolerances of 1, 2, 4, ...
+// image pixels. levels are built on first use and rebuilt when the source changes
+class PolygonLod {
+public:
+    // the polygon with less than half a screen pixel of error at `worldScale`
+    const QPolygonF &polygon(const QPolygonF &source, double worldScale);
+
+private:
+    QPolygonF          mSource;
+    QVector<QPolygonF> mLevels;
+    const int          mLevelCount = 8;
+};
+
+// hit tests on a large polygon without walking all of it: a bounding box reject, the edges
+// binned into horizontal bands for the winding number and the vertices binned on a grid for
+// handles. the polygon stays with the caller, moved vertices and translations update the bins
+// in place. small polygons are scanned whole by the batched kernels
+class PolygonIndex {
+public:
+    void build(const QPolygonF &polygon);
+    void clear();
+    bool isValid() const;
+
+    // after polygon[ index ] moved away from `from`
+    void moveVertex(const QPolygonF &polygon, int index, const QPointF &from);
+    // after the whole polygon moved by `delta`
+    void translate(const QPointF &delta);
+
+    // winding fill
+    bool contains(const QPolygonF &polygon, const QPointF &pos) const;
+    // lowest vertex closer than `radius`, -1 if there is none
+    int vertexAt(const QPolygonF &polygon, const QPointF &pos, double radius) const;
+
+private:
+    int     bandOf(double y) const;
+    quint64 cellOf(const QPointF &point) const;
+    void    addEdge(const QPolygonF &polygon, int index);
+    void    removeEdge(int index, const QPointF &p0, const QPointF &p1);
+
+private:
+    bool                         mValid = false;
+    QRectF                       mBox;    // may only grow while vertices move
+    QPointF                      mOffset; // translation since the bins were built
+    double                       mBandTop    = 0.;
+    double                       mBandHeight = 1.;
+    QVector<QVector<int>>        mBands; // edge i goes from vertex i to i + 1
+    QHash<quint64, QVector<int>> mCells;
+    double                       mCellSize = 1.;
+
+    const int mMinVertices = 64; // fewer are tested directly
+    const int mMaxCells    = 64; // per query, more scan all vertices
+};
+
 #endif
@@ -0,0 +1,21 @@
+// compiled with avx enabled, only called when the cpu has it. nothing but the kernels may be
+// included here, see utilssimd.h
+#include "utilssimd.h"
+
+int simd::avx::nearestPoint(const double *xy, int count, double px, double py, double *distance2) {
+    return simd::nearestPoint<Avx>(xy, count, px, py, distance2);
+}
+
+int simd::avx::nearestSegment(const double *xy, int count, bool closed, double px, double py,
+                              double *distance2) {
+    return simd::nearestSegment<Avx>(xy, count, closed, px, py, distance2);
+}
+
+int simd::avx::pointsWithin(const double *xy, int count, double px, double py, double radius2,
+                            int *indices, int limit) {
+    return simd::pointsWithin<Avx>(xy, count, px, py, radius2, indices, limit);
+}
+
+int simd::avx::winding(const double *xy, int count, double px, double py) {
+    return simd::winding<Avx>(xy, count, px, py);
+}
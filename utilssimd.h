@@ -0,0 +1,331 @@
+#ifndef UTILSSIMD_H
+#define UTILSSIMD_H
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTILS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// kernels behind the batched point queries of utils.h, written once over the lane type. points
+// are interleaved x, y doubles. utils.cpp instantiates them for plain code and sse2, utilsavx.cpp
+// for avx with its own compiler flags. only intrinsics and internal functions here, an inline
+// function shared by both translation units could end up compiled for avx in the whole program
+namespace simd {
+namespace {
+
+struct Scalar {
+    using V = double;
+    using M = bool;
+
+    static constexpr int lanes = 1;
+
+    static V    set(double value) { return value; }
+    static void store(double *out, V value) { out[ 0 ] = value; }
+    static void load(const double *xy, V &x, V &y) {
+        x = xy[ 0 ];
+        y = xy[ 1 ];
+    }
+
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return a < b ? a : b; }
+    static V max(V a, V b) { return a > b ? a : b; }
+
+    static M lt(V a, V b) { return a < b; }
+    static M le(V a, V b) { return a <= b; }
+    static M gt(V a, V b) { return a > b; }
+    static M both(M a, M b) { return a && b; }
+    static M either(M a, M b) { return a != b; }
+    static M butNot(M a, M b) { return a && !b; }
+    static V select(M mask, V a, V b) { return mask ? a : b; }
+    static int bits(M mask) { return mask ? 1 : 0; }
+};
+
+#ifdef UTILS_SSE2
+struct Sse2 {
+    using V = __m128d;
+    using M = __m128d;
+
+    static constexpr int lanes = 2;
+
+    static V    set(double value) { return _mm_set1_pd(value); }
+    static void store(double *out, V value) { _mm_storeu_pd(out, value); }
+    static void load(const double *xy, V &x, V &y) {
+        const auto p0 = _mm_loadu_pd(xy);
+        const auto p1 = _mm_loadu_pd(xy + 2);
+        x             = _mm_unpacklo_pd(p0, p1);
+        y             = _mm_unpackhi_pd(p0, p1);
+    }
+
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+    static V min(V a, V b) { return _mm_min_pd(a, b); }
+    static V max(V a, V b) { return _mm_max_pd(a, b); }
+
+    static M lt(V a, V b) { return _mm_cmplt_pd(a, b); }
+    static M le(V a, V b) { return _mm_cmple_pd(a, b); }
+    static M gt(V a, V b) { return _mm_cmpgt_pd(a, b); }
+    static M both(M a, M b) { return _mm_and_pd(a, b); }
+    static M either(M a, M b) { return _mm_xor_pd(a, b); }
+    static M butNot(M a, M b) { return _mm_andnot_pd(b, a); }
+    static V select(M mask, V a, V b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+    static int bits(M mask) { return _mm_movemask_pd(mask); }
+};
+#endif
+
+#ifdef __AVX__
+struct Avx {
+    using V = __m256d;
+    using M = __m256d;
+
+    static constexpr int lanes = 4;
+
+    static V    set(double value) { return _mm256_set1_pd(value); }
+    static void store(double *out, V value) { _mm256_storeu_pd(out, value); }
+    static void load(const double *xy, V &x, V &y) {
+        // x0 y0 x1 y1 and x2 y2 x3 y3 to x0 y0 x2 y2 and x1 y1 x3 y3, then split
+        const auto p01 = _mm256_loadu_pd(xy);
+        const auto p23 = _mm256_loadu_pd(xy + 4);
+        const auto p02 = _mm256_permute2f128_pd(p01, p23, 0x20);
+        const auto p13 = _mm256_permute2f128_pd(p01, p23, 0x31);
+        x              = _mm256_unpacklo_pd(p02, p13);
+        y              = _mm256_unpackhi_pd(p02, p13);
+    }
+
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    static V max(V a, V b) { return _mm256_max_pd(a, b); }
+
+    static M lt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static M le(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static M gt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static M both(M a, M b) { return _mm256_and_pd(a, b); }
+    static M either(M a, M b) { return _mm256_xor_pd(a, b); }
+    static M butNot(M a, M b) { return _mm256_andnot_pd(b, a); }
+    static V select(M mask, V a, V b) { return _mm256_blendv_pd(b, a, mask); }
+    static int bits(M mask) { return _mm256_movemask_pd(mask); }
+};
+#endif
+
+inline int ones(int bits) {
+    int count = 0;
+    for (; bits; bits >>= 1) {
+        count += bits & 1;
+    }
+    return count;
+}
+
+template <class S>
+typename S::V pointDistance2(const double *xy, typename S::V px, typename S::V py) {
+    typename S::V x, y;
+    S::load(xy, x, y);
+    const auto dx = S::sub(x, px);
+    const auto dy = S::sub(y, py);
+    return S::add(S::mul(dx, dx), S::mul(dy, dy));
+}
+
+// to the segment from `a` to `b`, to the end point for a degenerate one
+template <class S>
+typename S::V segmentDistance2(const double *a, const double *b, typename S::V px,
+                               typename S::V py) {
+    typename S::V ax, ay, bx, by;
+    S::load(a, ax, ay);
+    S::load(b, bx, by);
+    const auto abx  = S::sub(bx, ax);
+    const auto aby  = S::sub(by, ay);
+    const auto apx  = S::sub(px, ax);
+    const auto apy  = S::sub(py, ay);
+    const auto ab2  = S::add(S::mul(abx, abx), S::mul(aby, aby));
+    const auto zero = S::set(0.);
+    const auto dot  = S::add(S::mul(apx, abx), S::mul(apy, aby));
+    const auto t    = S::select(S::gt(ab2, zero),
+                                S::max(S::min(S::div(dot, ab2), S::set(1.)), zero), zero);
+    const auto dx   = S::sub(apx, S::mul(abx, t));
+    const auto dy   = S::sub(apy, S::mul(aby, t));
+    return S::add(S::mul(dx, dx), S::mul(dy, dy));
+}
+
+// edges from `a` to `b` crossing the row of the point right of it, by direction
+template <class S>
+void crossings(const double *a, const double *b, typename S::V px, typename S::V py,
+               typename S::M &up, typename S::M &down) {
+    typename S::V ax, ay, bx, by;
+    S::load(a, ax, ay);
+    S::load(b, bx, by);
+    const auto crosses = S::either(S::le(ay, py), S::le(by, py));
+    const auto dy      = S::sub(by, ay);
+    const auto x       = S::add(ax, S::div(S::mul(S::sub(py, ay), S::sub(bx, ax)), dy));
+    const auto hit     = S::both(crosses, S::gt(x, px));
+    const auto rising  = S::gt(by, ay);
+    up                 = S::both(hit, rising);
+    down               = S::butNot(hit, rising);
+}
+
+// smallest distance over all items first, then the first item at it. two passes without any
+// index bookkeeping are faster than one with it. `distance2` gives the items from i on, for
+// the lane type of its first argument
+template <class S, class Distance2>
+int nearest(int count, double px, double py, double *distance2, const Distance2 &distance2Of) {
+    const auto x     = S::set(px);
+    const auto y     = S::set(py);
+    auto       best0 = S::set(HUGE_VAL);
+    auto       best1 = best0;
+
+    int i = 0;
+    for (; i <= count - 2 * S::lanes; i += 2 * S::lanes) {
+        best0 = S::min(best0, distance2Of(S(), i, x, y));
+        best1 = S::min(best1, distance2Of(S(), i + S::lanes, x, y));
+    }
+    for (; i <= count - S::lanes; i += S::lanes) {
+        best0 = S::min(best0, distance2Of(S(), i, x, y));
+    }
+
+    double minima[ S::lanes ];
+    S::store(minima, S::min(best0, best1));
+    double best = HUGE_VAL;
+    for (const auto lane : minima) {
+        best = lane < best ? lane : best;
+    }
+    for (; i < count; i++) {
+        const auto d2 = distance2Of(Scalar(), i, px, py);
+        best          = d2 < best ? d2 : best;
+    }
+
+    if (distance2) {
+        *distance2 = best;
+    }
+    if (!(best < HUGE_VAL)) {
+        return -1;
+    }
+
+    // the same arithmetic again, the first match is exact
+    const auto bound = S::set(best);
+    for (i = 0; i <= count - S::lanes; i += S::lanes) {
+        if (const int bits = S::bits(S::le(distance2Of(S(), i, x, y), bound))) {
+            int lane = 0;
+            while (!(bits & (1 << lane))) {
+                lane++;
+            }
+            return i + lane;
+        }
+    }
+    for (; i < count; i++) {
+        if (distance2Of(Scalar(), i, px, py) <= best) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+template <class S>
+int nearestPoint(const double *xy, int count, double px, double py, double *distance2) {
+    return nearest<S>(count, px, py, distance2, [ xy ](auto lanes, int i, auto x, auto y) {
+        return pointDistance2<decltype(lanes)>(xy + 2 * i, x, y);
+    });
+}
+
+template <class S>
+int nearestSegment(const double *xy, int count, bool closed, double px, double py,
+                   double *distance2) {
+    // segment i ends at point i + 1, the closing one is tested on its own
+    const auto open = [ xy ](auto lanes, int i, auto x, auto y) {
+        return segmentDistance2<decltype(lanes)>(xy + 2 * i, xy + 2 * i + 2, x, y);
+    };
+    double found2 = HUGE_VAL;
+    int    found  = nearest<S>(count - 1, px, py, &found2, open);
+    if (closed && count > 1) {
+        const auto d2 = segmentDistance2<Scalar>(xy + 2 * (count - 1), xy, px, py);
+        if (d2 < found2) {
+            found  = count - 1;
+            found2 = d2;
+        }
+    }
+
+    if (distance2) {
+        *distance2 = found2;
+    }
+    return found;
+}
+
+template <class S>
+int pointsWithin(const double *xy, int count, double px, double py, double radius2, int *indices,
+                 int limit) {
+    const auto x  = S::set(px);
+    const auto y  = S::set(py);
+    const auto r2 = S::set(radius2);
+
+    int found = 0;
+    int i     = 0;
+    for (; i <= count - S::lanes && found < limit; i += S::lanes) {
+        int bits = S::bits(S::lt(pointDistance2<S>(xy + 2 * i, x, y), r2));
+        for (int lane = 0; bits && found < limit; lane++, bits >>= 1) {
+            if (bits & 1) {
+                indices[ found++ ] = i + lane;
+            }
+        }
+    }
+    for (; i < count && found < limit; i++) {
+        if (pointDistance2<Scalar>(xy + 2 * i, px, py) < radius2) {
+            indices[ found++ ] = i;
+        }
+    }
+
+    return found;
+}
+
+template <class S>
+int winding(const double *xy, int count, double px, double py) {
+    if (count < 1) {
+        return 0;
+    }
+
+    const auto x = S::set(px);
+    const auto y = S::set(py);
+
+    // edge i ends at point i + 1, the closing one is tested on its own
+    int result = 0;
+    int i      = 0;
+    for (; i < count - S::lanes; i += S::lanes) {
+        typename S::M up, down;
+        crossings<S>(xy + 2 * i, xy + 2 * i + 2, x, y, up, down);
+        result += ones(S::bits(up)) - ones(S::bits(down));
+    }
+    for (; i < count; i++) {
+        bool up, down;
+        crossings<Scalar>(xy + 2 * i, i + 1 < count ? xy + 2 * i + 2 : xy, px, py, up, down);
+        result += (up ? 1 : 0) - (down ? 1 : 0);
+    }
+
+    return result;
+}
+
+} // namespace
+} // namespace simd
+
+// avx kernels from utilsavx.cpp, only called when the cpu has avx
+namespace simd::avx {
+int nearestPoint(const double *xy, int count, double px, double py, double *distance2);
+int nearestSegment(const double *xy, int count, bool closed, double px, double py,
+                   double *distance2);
+int pointsWithin(const double *xy, int count, double px, double py, double radius2, int *indices,
+                 int limit);
+int winding(const double *xy, int count, double px, double py);
+} // namespace simd::avx
+
+#endif // UTILSSIMD_H